@@ -1,14 +1,469 @@
 #include "DArgumentParser.h"
 
-#include <sstream>
-#include <iomanip>
 #include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <cerrno>
+#include <atomic>
+#include <bitset>
+#include <thread>
+#include <sys/uio.h>
+#include <unistd.h>
 
 const char *argOptionTakesValueString = "<value> "; //size of 8
 const char *helpAndVersionOptionsSectionOpeningString = "\nGetting help:\n";
 const char *normalOptionSectionOpeningString = "\nOptions:\n";
-const char minusSign = '-', equalSign = '=';
+const std::string_view paddingSpaces = "                                ";
+const char minusSign = '-', equalSign = '=', responseFileSign = '@';
 const int shortCommandStartPos = 1, longCommandStartPos = 2;
+const int maxResponseFileDepth = 32;
+const size_t batchChunkSize = 1024;
+const char configSectionStart = '[', configSectionEnd = ']';
+const std::string_view completionQuery = "__complete";
+const size_t maxSuggestions = 3, maxSuggestionDistance = 3, maxSuggestedCommandSize = 64;
+const unsigned schemaImageMagic = 0x49504144, schemaImageVersion = 1; //"DAPI" when read on little endian machines
+const unsigned schemaImageResponseFilesFlag = 1, schemaImageAbbreviationsFlag = 2;
+const size_t schemaImageEntrySize = 3 * sizeof(unsigned);
+
+/**
+ * Positions of the words of the schema image header, all offsets are in bytes, strings are referenced by an offset into the string section followed by their size.
+ * <br>The header is followed by the option records (type, value type and multiple values flag, description), the short command index (256 option positions, -1 if unused) and the long command and environment variable tables (string, option position), sorted by their strings, and lastly by the string section.
+ */
+enum SchemaImageHeader : size_t {
+    ImageMagic,
+    ImageVersion,
+    ImageSize,
+    ImageFlags,
+    ImageOptionCount,
+    ImageLongCommandCount,
+    ImageEnvironmentCount,
+    ImageOptionsOffset,
+    ImageShortIndexOffset,
+    ImageLongIndexOffset,
+    ImageEnvironmentIndexOffset,
+    ImageStringsOffset,
+    ImageStringsSize,
+    ImageHelpText,
+    ImageHelpTextSize,
+    ImageVersionText,
+    ImageVersionTextSize,
+    ImageHeaderSize
+};
+#ifdef DARGUMENTPARSER_INSTRUMENTATION
+const bool instrumentationEnabled = true;
+#else
+const bool instrumentationEnabled = false;
+#endif
+
+//same characters as std::isspace in the "C" locale, without going through the locale for every character
+static bool isWhitespace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static std::string_view trimWhitespaces(std::string_view text) {
+    while (!text.empty() && isWhitespace(text.front()))
+        text.remove_prefix(1);
+    while (!text.empty() && isWhitespace(text.back()))
+        text.remove_suffix(1);
+    return text;
+}
+
+/**
+ * Reads the entries of a config file, the keys and values are views into the text.
+ * @return Returns 0 if every line is valid, otherwise the number of the first malformed line.
+ */
+template<typename Entry>
+static size_t readConfigEntries(std::string_view text, std::pmr::vector<Entry> &entries) {
+    size_t lineNumber = 0;
+    while (!text.empty()) {
+        lineNumber++;
+        size_t lineEnd = text.find('\n');
+        std::string_view line = trimWhitespaces(text.substr(0, lineEnd));
+        text.remove_prefix(lineEnd == std::string_view::npos ? text.size() : lineEnd + 1);
+        if (line.empty() || line.front() == '#' || line.front() == ';')
+            continue;
+        if (line.front() == configSectionStart) {
+            if (line.back() != configSectionEnd)
+                return lineNumber;
+            continue;
+        }
+        size_t posOfEqualSign = line.find(equalSign);
+        std::string_view key = trimWhitespaces(line.substr(0, posOfEqualSign));
+        if (key.empty() || std::any_of(key.begin(), key.end(), isWhitespace))
+            return lineNumber;
+        if (posOfEqualSign == std::string_view::npos) {
+            entries.push_back(Entry{key, {}, false});
+            continue;
+        }
+        std::string_view value = trimWhitespaces(line.substr(posOfEqualSign + 1));
+        if (value.size() >= 2 && (value.front() == '"' || value.front() == '\'') && value.back() == value.front())
+            value = value.substr(1, value.size() - 2);
+        entries.push_back(Entry{key, value, true});
+    }
+    return 0;
+}
+
+/**
+ * Splits the text on whitespaces, without any special handling for quotes or backslashes, so every argument is a view into the text itself.
+ */
+static void splitArgumentsOnWhitespaces(std::string_view text, std::pmr::vector<std::string_view> &output) {
+    size_t argumentStart = 0;
+    for (size_t index = 0; index <= text.size(); index++) {
+        if (index < text.size() && !isWhitespace(text[index]))
+            continue;
+        if (index > argumentStart)
+            output.push_back(text.substr(argumentStart, index - argumentStart));
+        argumentStart = index + 1;
+    }
+}
+
+static bool equalsIgnoringCase(std::string_view first, std::string_view second) {
+    if (first.size() != second.size())
+        return false;
+    for (size_t i = 0; i < first.size(); i++)
+        if (std::tolower((unsigned char) first[i]) != std::tolower((unsigned char) second[i]))
+            return false;
+    return true;
+}
+
+/**
+ * std::from_chars doesn't accept a leading plus sign, so it's removed here (a plus followed by a minus sign is still rejected).
+ */
+static bool removePlusSign(std::string_view &text) {
+    if (text.empty() || text.front() != '+')
+        return true;
+    text.remove_prefix(1);
+    return !text.empty() && text.front() != '-';
+}
+
+static bool convertInteger(std::string_view text, long long &result) {
+    if (!removePlusSign(text) || text.empty())
+        return false;
+    //converted into a temporary, so a value with trailing characters doesn't leave its leading number behind
+    long long number;
+    auto [end, errorCode] = std::from_chars(text.data(), text.data() + text.size(), number);
+    if (errorCode != std::errc() || end != text.data() + text.size())
+        return false;
+    result = number;
+    return true;
+}
+
+/**
+ * Converts the leading number of the text, the remaining characters are returned in suffix.
+ */
+static bool convertFloatingPoint(std::string_view text, double &result, std::string_view &suffix) {
+    if (!removePlusSign(text) || text.empty())
+        return false;
+    auto [end, errorCode] = std::from_chars(text.data(), text.data() + text.size(), result);
+    if (errorCode != std::errc())
+        return false;
+    suffix = text.substr(end - text.data());
+    return true;
+}
+
+static bool convertFloatingPoint(std::string_view text, double &result) {
+    double number;
+    std::string_view suffix;
+    if (!convertFloatingPoint(text, number, suffix) || !suffix.empty())
+        return false;
+    result = number;
+    return true;
+}
+
+static bool convertBoolean(std::string_view text, bool &result) {
+    for (auto trueText: {"true", "yes", "on", "1"})
+        if (equalsIgnoringCase(text, trueText))
+            return (result = true);
+    for (auto falseText: {"false", "no", "off", "0"})
+        if (equalsIgnoringCase(text, falseText))
+            return !(result = false);
+    return false;
+}
+
+static bool convertDuration(std::string_view text, std::chrono::nanoseconds &result) {
+    const std::pair<std::string_view, double> units[] = {{"",   1e9},
+                                                         {"ns", 1},
+                                                         {"us", 1e3},
+                                                         {"ms", 1e6},
+                                                         {"s",  1e9},
+                                                         {"m",  60e9},
+                                                         {"h",  3600e9},
+                                                         {"d",  86400e9}};
+    double number;
+    std::string_view suffix;
+    if (!convertFloatingPoint(text, number, suffix) || !(number >= 0))
+        return false;
+    for (const auto &unit: units) {
+        if (!equalsIgnoringCase(suffix, unit.first))
+            continue;
+        double nanoseconds = number * unit.second;
+        if (nanoseconds >= 9.2e18)
+            return false;
+        result = std::chrono::nanoseconds((long long) nanoseconds);
+        return true;
+    }
+    return false;
+}
+
+static bool convertByteSize(std::string_view text, unsigned long long &result) {
+    const double kibi = 1024, kilo = 1000;
+    //matched exactly, the case is what tells "K" (1024) and "kB" (1000) apart
+    const std::pair<std::string_view, double> units[] = {{"",    1},
+                                                         {"B",   1},
+                                                         {"K",   kibi},
+                                                         {"KiB", kibi},
+                                                         {"kB",  kilo},
+                                                         {"M",   kibi * kibi},
+                                                         {"MiB", kibi * kibi},
+                                                         {"MB",  kilo * kilo},
+                                                         {"G",   kibi * kibi * kibi},
+                                                         {"GiB", kibi * kibi * kibi},
+                                                         {"GB",  kilo * kilo * kilo},
+                                                         {"T",   kibi * kibi * kibi * kibi},
+                                                         {"TiB", kibi * kibi * kibi * kibi},
+                                                         {"TB",  kilo * kilo * kilo * kilo}};
+    double number;
+    std::string_view suffix;
+    if (!convertFloatingPoint(text, number, suffix) || !(number >= 0))
+        return false;
+    for (const auto &unit: units) {
+        if (suffix != unit.first)
+            continue;
+        double bytes = number * unit.second;
+        if (bytes >= 1.8e19)
+            return false;
+        result = (unsigned long long) (bytes + 0.5);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Writes the printable error text into a string of any allocator, replacing its contents.
+ */
+template<typename String>
+static void writeErrorText(String &errorText, DParseResult error, std::string_view command) {
+    errorText.clear();
+    switch (error) {
+        case DParseResult::InvalidOption:
+            errorText += "Option --";
+            errorText += command;
+            errorText += " is invalid";
+            break;
+        case DParseResult::ValuePassedToOptionThatDoesNotTakeValue:
+            errorText += "Option --";
+            errorText += command;
+            errorText += " received a value but it doesn't take any";
+            break;
+        case DParseResult::NoValueWasPassedToOption:
+            errorText += "Option --";
+            errorText += command;
+            errorText += " takes a value but none was passed.";
+            break;
+        case DParseResult::InvalidValue:
+            errorText += "Option --";
+            errorText += command;
+            errorText += " received a value in an invalid format";
+            break;
+        case DParseResult::InvalidResponseFile:
+            errorText += "Response file ";
+            errorText += command;
+            errorText += " could not be read";
+            break;
+        case DParseResult::AmbiguousOption:
+            errorText += "Option --";
+            errorText += command;
+            errorText += " is ambiguous";
+            break;
+        case DParseResult::InvalidConfigFile:
+            errorText += "Config file ";
+            errorText += command;
+            errorText += " could not be read";
+            break;
+        case DParseResult::InvalidSubcommand:
+            errorText += "Command ";
+            errorText += command;
+            errorText += " is invalid";
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * Same as writeErrorText, for an entry of a config file, naming the file.
+ */
+template<typename String>
+static void writeConfigErrorText(String &errorText, DParseResult error, std::string_view key, std::string_view path) {
+    writeErrorText(errorText, error, key);
+    errorText.insert(0, ": ");
+    errorText.insert(0, path);
+    errorText.insert(0, "Config file ");
+}
+
+template<typename String>
+static void writeEnvironmentErrorText(String &errorText, std::string_view variable) {
+    errorText.clear();
+    errorText += "Environment variable ";
+    errorText += variable;
+    errorText += " has a value in an invalid format";
+}
+
+/**
+ * Appends the commands an ambiguous abbreviation could stand for to its error text.
+ */
+template<typename String>
+static void writeAmbiguousCandidates(String &errorText, const std::pmr::vector<std::string_view> &candidates) {
+    errorText += ", it could be";
+    for (size_t index = 0; index < candidates.size(); index++) {
+        errorText += index == 0 ? " --" : ", --";
+        errorText += candidates[index];
+    }
+}
+
+/**
+ * Appends the commands closest to an invalid one to its error text.
+ */
+template<typename String>
+static void writeSuggestions(String &errorText, const std::pmr::vector<std::string_view> &suggestions) {
+    errorText += ", did you mean";
+    for (size_t index = 0; index < suggestions.size(); index++) {
+        errorText += index == 0 ? " --" : index + 1 == suggestions.size() ? " or --" : ", --";
+        errorText += suggestions[index];
+    }
+    errorText += '?';
+}
+
+static unsigned long long characterMask(std::string_view text) {
+    unsigned long long mask = 0;
+    for (char c: text)
+        mask |= 1ULL << ((unsigned char) c % 64);
+    return mask;
+}
+
+/**
+ * Edit distance between a pattern of up to 64 characters, given by the masks of the positions each character appears at, and text, counting a swap of adjacent characters as a single edit.
+ * <br>Computed a column at a time with Myers' bit-parallel algorithm, in Hyyrö's formulation for whole strings with transpositions.
+ * @return Returns the distance, or something greater than maxDistance as soon as it can't get down to maxDistance anymore.
+ */
+static size_t boundedEditDistance(const std::array<unsigned long long, 256> &patternMasks, size_t patternSize, std::string_view text, size_t maxDistance) {
+    const unsigned long long lastBit = 1ULL << (patternSize - 1);
+    unsigned long long positive = ~0ULL, negative = 0, diagonal = 0, previousMatches = 0;
+    size_t distance = patternSize;
+    for (size_t index = 0; index < text.size(); index++) {
+        unsigned long long matches = patternMasks[(unsigned char) text[index]];
+        unsigned long long transpositions = ((~diagonal & matches) << 1) & previousMatches;
+        diagonal = (((matches & positive) + positive) ^ positive) | matches | negative | transpositions;
+        unsigned long long horizontalPositive = negative | ~(diagonal | positive);
+        unsigned long long horizontalNegative = positive & diagonal;
+        if (horizontalPositive & lastBit)
+            distance++;
+        else if (horizontalNegative & lastBit)
+            distance--;
+        //each remaining character can only take one off the distance
+        if (distance > maxDistance + (text.size() - index - 1))
+            return maxDistance + 1;
+        horizontalPositive = horizontalPositive << 1 | 1;
+        horizontalNegative <<= 1;
+        positive = horizontalNegative | ~(diagonal | horizontalPositive);
+        negative = horizontalPositive & diagonal;
+        previousMatches = matches;
+    }
+    return distance;
+}
+
+template<typename String>
+static void writeErrorText(String &errorText, DParseResult error, char command) {
+    errorText.clear();
+    switch (error) {
+        case DParseResult::InvalidOption:
+            errorText += "Option -";
+            errorText += command;
+            errorText += " is invalid";
+            break;
+        case DParseResult::ValuePassedToOptionThatDoesNotTakeValue:
+            errorText += "Option -";
+            errorText += command;
+            errorText += " received a value but it doesn't take any";
+            break;
+        case DParseResult::NoValueWasPassedToOption:
+            errorText += "Option -";
+            errorText += command;
+            errorText += " takes a value but none was passed.";
+            break;
+        case DParseResult::OptionsThatTakesValueNeedsToBeSetSeparately:
+            errorText += "Options that takes a value needs to be set separately. Error with option: -";
+            errorText += command;
+            break;
+        case DParseResult::InvalidValue:
+            errorText += "Option -";
+            errorText += command;
+            errorText += " received a value in an invalid format";
+            break;
+        default:
+            break;
+    }
+}
+
+/* ------ help sinks ------ */
+DStringHelpSink::DStringHelpSink(std::string &_output) : output(_output) {}
+
+void DStringHelpSink::Write(std::string_view text) {
+    output += text;
+}
+
+DFileHelpSink::DFileHelpSink(FILE *_file) : file(_file) {}
+
+void DFileHelpSink::Write(std::string_view text) {
+    fwrite(text.data(), 1, text.size(), file);
+}
+
+void DFileHelpSink::Flush() {
+    fflush(file);
+}
+
+DFileDescriptorHelpSink::DFileDescriptorHelpSink(int _fileDescriptor) : fileDescriptor(_fileDescriptor) {}
+
+DFileDescriptorHelpSink::~DFileDescriptorHelpSink() {
+    DFileDescriptorHelpSink::Flush();
+}
+
+void DFileDescriptorHelpSink::Write(std::string_view text) {
+    if (text.empty())
+        return;
+    pending[pendingCount++] = text;
+    if (pendingCount == (int) pending.size())
+        Flush();
+}
+
+void DFileDescriptorHelpSink::Flush() {
+    iovec batch[pendingBatchSize];
+    for (int i = 0; i < pendingCount; i++)
+        batch[i] = {const_cast<char *>(pending[i].data()), pending[i].size()};
+    iovec *current = batch;
+    int remaining = pendingCount;
+    pendingCount = 0;
+    while (remaining > 0) {
+        ssize_t written = writev(fileDescriptor, current, remaining);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        //partial writes: skip the buffers that were fully written and advance into the first one that wasn't
+        while (remaining > 0 && (size_t) written >= current->iov_len) {
+            written -= (ssize_t) current->iov_len;
+            ++current;
+            --remaining;
+        }
+        if (remaining > 0) {
+            current->iov_base = static_cast<char *>(current->iov_base) + written;
+            current->iov_len -= written;
+        }
+    }
+}
 
 /* ------ DArgumentOption ------ */
 DArgumentOption::DArgumentOption() : type(DArgumentOptionType::NormalOption) {}
@@ -22,6 +477,7 @@ DArgumentOption::DArgumentOption(DArgumentOptionType _type, std::string _descrip
 bool DArgumentOption::AddShortCommand(char shortCommand) {
     if (shortCommand < 33 || shortCommand == minusSign || shortCommand == 127)
         return false;
+    revision++;
     return shortCommands.insert(shortCommand).second;
 }
 
@@ -29,6 +485,7 @@ bool DArgumentOption::AddShortCommand(std::set<char> &&_shortCommands) {
     for (auto shortCommand: _shortCommands)
         if (shortCommand < 33 || shortCommand == minusSign || shortCommand == 127)
             return false;
+    revision++;
     shortCommands.merge(_shortCommands);
     return true;
 }
@@ -38,12 +495,14 @@ const std::set<char> &DArgumentOption::ShortCommands() const {
 }
 
 void DArgumentOption::ClearShortCommands() {
+    revision++;
     shortCommands.clear();
 }
 
 bool DArgumentOption::AddLongCommand(const std::string &longCommand) {
     if (longCommand.front() == minusSign || longCommand.find(equalSign) != std::string::npos)
         return false;
+    revision++;
     return longCommands.insert(longCommand).second;
 }
 
@@ -51,6 +510,7 @@ bool DArgumentOption::AddLongCommand(std::set<std::string> &&_longCommands) {
     for (auto longCommand: _longCommands)
         if (longCommand.front() == minusSign || longCommand.find(equalSign) != std::string::npos)
             return false;
+    revision++;
     longCommands.merge(_longCommands);
     return true;
 }
@@ -60,10 +520,12 @@ const std::set<std::string> &DArgumentOption::LongCommands() const {
 }
 
 void DArgumentOption::ClearLongCommands() {
+    revision++;
     longCommands.clear();
 }
 
 void DArgumentOption::AddDescription(const std::string &_description) {
+    revision++;
     description = _description;
 }
 
@@ -72,427 +534,1567 @@ DArgumentOptionType DArgumentOption::GetType() const {
 }
 
 void DArgumentOption::SetType(DArgumentOptionType _type) {
+    revision++;
     type = _type;
 }
 
+bool DArgumentOption::SetEnvironmentVariable(const std::string &name) {
+    if (name.find(equalSign) != std::string::npos)
+        return false;
+    environmentVariable = name;
+    return true;
+}
+
+const std::string &DArgumentOption::EnvironmentVariable() const {
+    return environmentVariable;
+}
+
 int DArgumentOption::WasSet() const {
     return wasSet;
 }
 
-const std::string &DArgumentOption::GetValue() const {
-    return value;
+DValueSource DArgumentOption::GetValueSource() const {
+    return valueSource;
 }
 
-DArgumentParser::DArgumentParser(int argc, char **argv, std::string _appName, std::string _appVersion, std::string _appDescription) : argumentCount(argc), argumentValues(argv), executableName(getExecutableName(argv[0])), appName(std::move(_appName)), appVersion(std::move(_appVersion)), appDescription(std::move(_appDescription)) {}
+void DArgumentOption::SetValueType(DArgumentValueType _valueType) {
+    valueType = _valueType;
+}
 
-std::string DArgumentParser::getExecutableName(char *execCall) {
-    std::string execName(execCall);
-    return execName.substr(execName.find_last_of('/') + 1);
+DArgumentValueType DArgumentOption::GetValueType() const {
+    return valueType;
 }
 
-std::vector<int> DArgumentParser::calculateSizeOfOptionStrings(const std::vector<DArgumentOption *> &args) {
-    std::vector<int> sizes(args.size());
-    int index = 0;
-    for (auto arg: args) {
-        /** formula explanation:
-         * 2 * arg->shortCommands.size() -> adding the minus sign to a characters always leads to 2 characters, so we just need to multiply the amount of chars by 2
-         * arg->shortCommands.size() + arg->longCommands.size() -> the amount of spaces needed between commands, not reducing by 1 means we'll have one extra space total, but we can account for that when building the string and avoid branches.
-         * (arg->type == DArgumentOptionType::InputOption) * 8) -> if arg.type takes a value, we'll print "<value> " (8 characters) after it, because false/true resolves to 0/1, we can safely multiply by this comparison to avoid branching.
-         */
-        sizes[index] = (int) ((2 * arg->shortCommands.size()) + arg->shortCommands.size() + arg->longCommands.size() + ((arg->type == DArgumentOptionType::InputOption) * 8));//strlen("<value> ") == 8
-        auto iterator = arg->longCommands.begin(), end = arg->longCommands.end();
-        while (iterator != end) {
-            /** formula explanation:
-             * 2 + (*iterator).size() -> size of string plus two minus signs characters
-             */
-            sizes[index] += (int) (2 + (*iterator).size());
-            ++iterator;
-        }
-        index++;
-    }
-    return sizes;
+void DArgumentOption::SetMultipleValues(bool enabled) {
+    multipleValues = enabled;
 }
 
-std::vector<std::string> DArgumentParser::generateOptionStrings(const std::vector<DArgumentOption *> &args, const std::vector<int> &sizes, int columnSize) {
-    std::vector<std::string> optionStrings;
-    optionStrings.reserve(args.size());
-    int index = 0;
-    for (auto arg: args) {
-        std::ostringstream ostringstream;
-        ostringstream << "   " << std::setw(columnSize) << std::left;
-        std::string tempStr;
-        tempStr.reserve(sizes[index]);
-        for (auto c: arg->shortCommands) {
-            tempStr += minusSign;
-            tempStr += c;
-            tempStr += ' ';
-        }
-        for (const auto &str: arg->longCommands) {
-            tempStr += "--";
-            tempStr += str;
-            tempStr += ' ';
-        }
-        if (arg->type == DArgumentOptionType::InputOption)
-            tempStr += argOptionTakesValueString;
-        ostringstream << tempStr;
-        if (!arg->description.empty())
-            ostringstream << "  " << arg->description;
-        ostringstream << '\n';
-        optionStrings.emplace_back(std::move(ostringstream.str()));
-        index++;
+bool DArgumentOption::HasMultipleValues() const {
+    return multipleValues;
+}
+
+bool DArgumentOption::setValue(std::string_view _value) {
+    valueView = _value;
+    value.clear();
+    bool isValid = true;
+    switch (valueType) {
+        case DArgumentValueType::Integer:
+            isValid = convertInteger(_value, integerValue) && (!std::holds_alternative<int>(boundDefault) || (integerValue >= std::numeric_limits<int>::min() && integerValue <= std::numeric_limits<int>::max()));
+            break;
+        case DArgumentValueType::FloatingPoint:
+            isValid = convertFloatingPoint(_value, floatingPointValue);
+            break;
+        case DArgumentValueType::Boolean:
+            isValid = convertBoolean(_value, booleanValue);
+            break;
+        case DArgumentValueType::Duration:
+            isValid = convertDuration(_value, durationValue);
+            break;
+        case DArgumentValueType::ByteSize:
+            isValid = convertByteSize(_value, byteSizeValue);
+            break;
+        default:
+            break;
     }
-    return optionStrings;
+    if (isValid && multipleValues)
+        values.push_back(_value);
+    return isValid;
 }
 
-std::string DArgumentParser::generateOptionsSubSection(const std::vector<DArgumentOption *> &args, const char *openingString) {
-    std::string sectionString = openingString;
-    std::vector<int> otherSizes = calculateSizeOfOptionStrings(args);
-    int optionCommandsColSize = 0;
-    for (int i = 0; i < args.size(); i++) {
-        if (otherSizes[i] > optionCommandsColSize)
-            optionCommandsColSize = otherSizes[i];
-    }
-    auto orderedOptionStrings = generateOptionStrings(args, otherSizes, optionCommandsColSize);
-    std::sort(orderedOptionStrings.begin(), orderedOptionStrings.end());
-    size_t totalSize = sectionString.size();
-    for (const auto &str: orderedOptionStrings)
-        totalSize += str.size();
-    sectionString.reserve(totalSize);
-    for (const auto &str: orderedOptionStrings)
-        sectionString += str;
-    return sectionString;
-}
-
-bool DArgumentParser::isLongCommand(const std::string &argument) {
-    return (argument.size() > longCommandStartPos && argument[0] == minusSign && argument[1] == minusSign);
+void DArgumentOption::resetValue() {
+    wasSet = 0;
+    valueSource = DValueSource::NotSet;
+    valueView = {};
+    value.clear();
+    values.clear();
+    integerValue = 0;
+    byteSizeValue = 0;
+    floatingPointValue = 0;
+    booleanValue = false;
+    durationValue = std::chrono::nanoseconds(0);
+    writeBinding();
 }
 
-bool DArgumentParser::isShortCommand(const std::string &argument) {
-    return (argument.size() > shortCommandStartPos && argument[0] == minusSign && argument[1] != minusSign);
+void DArgumentOption::writeBinding() const {
+    if (boundVariable == nullptr)
+        return;
+    bool isInput = type == DArgumentOptionType::InputOption, isSet = wasSet > 0;
+    std::visit([this, isInput, isSet](const auto &defaultValue) {
+        using Variable = std::decay_t<decltype(defaultValue)>;
+        if constexpr (std::is_same_v<Variable, bool>)
+            *static_cast<bool *>(boundVariable) = isSet ? !isInput || booleanValue : defaultValue;
+        else if constexpr (std::is_same_v<Variable, int> || std::is_same_v<Variable, long long>)
+            *static_cast<Variable *>(boundVariable) = isSet ? (Variable) (isInput ? integerValue : wasSet) : defaultValue;
+        else if constexpr (std::is_same_v<Variable, double>)
+            *static_cast<double *>(boundVariable) = isSet ? floatingPointValue : defaultValue;
+        else if constexpr (std::is_same_v<Variable, std::chrono::nanoseconds>)
+            *static_cast<std::chrono::nanoseconds *>(boundVariable) = isSet ? durationValue : defaultValue;
+        else if constexpr (std::is_same_v<Variable, unsigned long long>)
+            *static_cast<unsigned long long *>(boundVariable) = isSet ? byteSizeValue : defaultValue;
+        else if constexpr (std::is_same_v<Variable, std::string>)
+            static_cast<std::string *>(boundVariable)->assign(isSet ? valueView : std::string_view(defaultValue));
+    }, boundDefault);
 }
 
-bool DArgumentParser::checkIfArgumentIsUnique(DArgumentOption *dArgumentOption) {
-    if (argumentOptions.find(dArgumentOption) != argumentOptions.end())
+template<typename Variable>
+bool DArgumentOption::bind(Variable &variable, bool isNormalOptionAllowed, DArgumentValueType inputValueType) {
+    if (type != DArgumentOptionType::InputOption && !isNormalOptionAllowed)
         return false;
-    if (dArgumentOption->shortCommands.empty() && dArgumentOption->longCommands.empty())
-        return false;
-    for (auto argument: argumentOptions) {
-        auto shortEnd = argument->shortCommands.end();
-        for (auto shortCommand: dArgumentOption->shortCommands)
-            if (argument->shortCommands.find(shortCommand) != shortEnd)
-                return false;
-        auto longEnd = argument->longCommands.end();
-        for (auto &longCommand: dArgumentOption->longCommands)
-            if (argument->longCommands.find(longCommand) != longEnd)
-                return false;
-    }
+    if (type == DArgumentOptionType::InputOption)
+        valueType = inputValueType;
+    boundVariable = &variable;
+    boundDefault = variable;
     return true;
 }
 
-bool DArgumentParser::checkIfAllArgumentsInListAreUnique(const std::unordered_set<DArgumentOption *> &_arguments) {
-    for (auto upperIterator = _arguments.begin(), upperEnd = _arguments.end(); upperIterator != upperEnd; ++upperIterator) {
-        if (!checkIfArgumentIsUnique(*upperIterator))
-            return false;
-        auto lowerIterator = upperIterator;
-        if (++lowerIterator == upperEnd)
-            break;
-        for (; lowerIterator != upperEnd; ++lowerIterator) {
-            auto shortEnd = (*lowerIterator)->shortCommands.end();
-            for (auto shortCommand: (*upperIterator)->shortCommands)
-                if ((*lowerIterator)->shortCommands.find(shortCommand) != shortEnd)
-                    return false;
-            auto longEnd = (*lowerIterator)->longCommands.end();
-            for (auto &longCommand: (*upperIterator)->longCommands)
-                if ((*lowerIterator)->longCommands.find(longCommand) != longEnd)
-                    return false;
-        }
-    }
-    return true;
+bool DArgumentOption::Bind(bool &variable) {
+    return bind(variable, true, DArgumentValueType::Boolean);
 }
 
-std::string DArgumentParser::generateUsageSection() {
-    std::string usageString = "Usage: ";
-    std::string optionString = argumentOptions.empty() ? std::string() : std::string(" [options]");
-    std::string posArgString;
-    if (!positionalArgs.empty()) {
-        std::string::size_type totalSize = 0;
-        for (const auto &posArg: positionalArgs)
-            totalSize += std::get<2>(posArg).empty() ? std::get<0>(posArg).size() + 3 : std::get<2>(posArg).size() + 1;
-        posArgString.reserve(totalSize);
-        for (const auto &posArg: positionalArgs) {
-            if (std::get<2>(posArg).empty()) {
-                posArgString += " [";
-                posArgString += std::get<0>(posArg);
-                posArgString += ']';
-                continue;
-            }
-            posArgString += ' ';
-            posArgString += std::get<2>(posArg);
-        }
-    }
-    usageString.reserve(usageString.size() + executableName.size() + optionString.size() + posArgString.size() + 1);
-    usageString += executableName;
-    usageString += optionString;
-    usageString += posArgString;
-    usageString += '\n';
-    return usageString;
+bool DArgumentOption::Bind(int &variable) {
+    return bind(variable, true, DArgumentValueType::Integer);
 }
 
-std::string DArgumentParser::generateDescriptionSection() {
-    if (appDescription.empty())
-        return {};
-    std::string descriptionString;
-    descriptionString.reserve(2 + appDescription.size());
-    descriptionString += '\n';
-    descriptionString += appDescription;
-    descriptionString += '\n';
-    return descriptionString;
-}
-
-void DArgumentParser::calculateSizeOfArgumentsString(std::vector<int> &sizes) {
-    int index = 0;
-    for (auto arg: positionalArgs)
-        /** formula explanation:
-         * std::get<0>(arg).size() + 2 -> size of string plus size of 2 characters
-         */
-        sizes[index++] = (int) (std::get<2>(arg).empty() ? (std::get<0>(arg).size() + 2) : std::get<2>(arg).size());
+bool DArgumentOption::Bind(long long &variable) {
+    return bind(variable, true, DArgumentValueType::Integer);
 }
 
-std::string DArgumentParser::generatePositionalArgsSection() {
-    if (positionalArgs.empty())
-        return {};
-    std::string argSection = "\nArguments:\n";
-    std::vector<int> sizes(positionalArgs.size());
-    calculateSizeOfArgumentsString(sizes);
-    int optionArgsColSize = 0;
-    for (int i = 0; i < positionalArgs.size(); i++) {
-        if (sizes[i] > optionArgsColSize)
-            optionArgsColSize = sizes[i];
-    }
-    for (auto arg: positionalArgs) {
-        std::ostringstream ostringstream;
-        ostringstream << "   " << std::setw(optionArgsColSize) << std::left;
-        bool customSyntax = !std::get<2>(arg).empty();
-        if (customSyntax)
-            ostringstream << std::get<2>(arg);
-        else {
-            std::string tempStr;
-            tempStr.reserve(2 + std::get<0>(arg).size());
-            tempStr += '[';
-            tempStr += std::get<0>(arg);
-            tempStr += ']';
-            ostringstream << tempStr;
-        }
-        ostringstream << "   " << std::get<1>(arg) << '\n';
-        argSection += ostringstream.str();
-    }
-    return argSection;
+bool DArgumentOption::Bind(double &variable) {
+    return bind(variable, false, DArgumentValueType::FloatingPoint);
 }
 
-std::string DArgumentParser::generateOptionsSection() {
-    std::vector<DArgumentOption *> helpAndVersionOptions, normalOptions;
-    for (auto arg: argumentOptions)
-        if (arg->type == DArgumentOptionType::HelpOption || arg->type == DArgumentOptionType::VersionOption)
-            helpAndVersionOptions.push_back(arg);
-        else
-            normalOptions.push_back(arg);
-    std::string sectionString;
-    if (!helpAndVersionOptions.empty())
-        sectionString += generateOptionsSubSection(helpAndVersionOptions, helpAndVersionOptionsSectionOpeningString);
-    if (!normalOptions.empty())
-        sectionString += generateOptionsSubSection(normalOptions, normalOptionSectionOpeningString);
-    return sectionString;
+bool DArgumentOption::Bind(std::chrono::nanoseconds &variable) {
+    return bind(variable, false, DArgumentValueType::Duration);
 }
 
-void DArgumentParser::generateErrorText(DParseResult error, const std::string &command) {
-    switch (error) {
-        case DParseResult::InvalidOption:
-            errorText = "Option --" + command + " is invalid";
-            break;
-        case DParseResult::ValuePassedToOptionThatDoesNotTakeValue:
-            errorText = "Option --" + command + " received a value but it doesn't take any";
-            break;
-        case DParseResult::NoValueWasPassedToOption:
-            errorText = "Option --" + command + " takes a value but none was passed.";
-            break;
-        default:
-            return;
-    }
+bool DArgumentOption::Bind(unsigned long long &variable) {
+    return bind(variable, false, DArgumentValueType::ByteSize);
 }
 
-void DArgumentParser::generateErrorText(DParseResult error, char command) {
-    std::string str;
-    str = command;
-    switch (error) {
-        case DParseResult::InvalidOption:
-            errorText = "Option -" + str + " is invalid";
-            break;
-        case DParseResult::ValuePassedToOptionThatDoesNotTakeValue:
-            errorText = "Option -" + str + " received a value but it doesn't take any";
-            break;
-        case DParseResult::NoValueWasPassedToOption:
-            errorText = "Option -" + str + " takes a value but none was passed.";
-            break;
-        case DParseResult::OptionsThatTakesValueNeedsToBeSetSeparately:
-            errorText = "Options that takes a value needs to be set separately. Error with option: -" + str;
-            break;
-        default:
-            return;
-    }
+bool DArgumentOption::Bind(std::string &variable) {
+    return bind(variable, false, valueType);
 }
 
-void DArgumentParser::resetParsedValues() {
-    positionalArgsValues.clear();
-    errorText.clear();
-    for (auto arg: argumentOptions) {
-        arg->wasSet = 0;
-        arg->value.clear();
-    }
+void DArgumentOption::Unbind() {
+    boundVariable = nullptr;
+    boundDefault = std::monostate();
 }
 
-DParseResult DArgumentParser::parseLongCommand(const std::string &argument, int &currentIndex) {
-    size_t posOfEqualSign = argument.find_first_of(equalSign, longCommandStartPos);
-    std::string command = argument.substr(longCommandStartPos, posOfEqualSign - longCommandStartPos);
-    bool commandFound = false;
-    for (auto arg: argumentOptions) {
-        auto iterator = arg->longCommands.find(command);
-        if (iterator == arg->longCommands.end())
-            continue;
-        commandFound = true;
-        if (arg->type != DArgumentOptionType::InputOption && posOfEqualSign != std::string::npos) {
-            generateErrorText(DParseResult::ValuePassedToOptionThatDoesNotTakeValue, command);
-            return DParseResult::ValuePassedToOptionThatDoesNotTakeValue;
-        }
-        if (arg->type == DArgumentOptionType::InputOption) {
-            if (posOfEqualSign == std::string::npos) {
-                if (++currentIndex == argumentCount) {
-                    generateErrorText(DParseResult::NoValueWasPassedToOption, command);
-                    return DParseResult::NoValueWasPassedToOption;
-                }
-                arg->value = std::string(argumentValues[currentIndex]);
-                if (isLongCommand(arg->value) || isShortCommand(arg->value)) {
-                    generateErrorText(DParseResult::NoValueWasPassedToOption, command);
-                    return DParseResult::NoValueWasPassedToOption;
-                }
-            } else {
-                if (argument[posOfEqualSign] == argument[argument.size() - 1]) {
-                    generateErrorText(DParseResult::NoValueWasPassedToOption, command);
-                    return DParseResult::NoValueWasPassedToOption;
-                }
-                arg->value = argument.substr(posOfEqualSign + 1);
-            }
-        }
-        arg->wasSet++;
-        break;
-    }
-    if (!commandFound) {
-        generateErrorText(DParseResult::InvalidOption, command);
-        return DParseResult::InvalidOption;
-    }
-    return DParseResult::ParseSuccessful;
+const std::string &DArgumentOption::GetValue() const {
+    if (value.empty() && !valueView.empty())
+        value.assign(valueView);
+    return value;
 }
 
-DParseResult DArgumentParser::parseShortCommand(const std::string &argument, int &currentIndex) {
-    for (int i = 1; i < argument.size(); i++) {
-        bool commandFound = false;
-        for (auto arg: argumentOptions) {
-            auto iterator = arg->shortCommands.find(argument[i]);
-            if (iterator == arg->shortCommands.end())
-                continue;
-            commandFound = true;
-            if (arg->type == DArgumentOptionType::InputOption && argument.size() > 2) {
-                generateErrorText(DParseResult::OptionsThatTakesValueNeedsToBeSetSeparately, argument[i]);
-                return DParseResult::OptionsThatTakesValueNeedsToBeSetSeparately;
-            }
-            if (arg->type == DArgumentOptionType::InputOption) {
-                if (++currentIndex == argumentCount) {
-                    generateErrorText(DParseResult::NoValueWasPassedToOption, argument[i]);
-                    return DParseResult::NoValueWasPassedToOption;
-                }
-                arg->value = std::string(argumentValues[currentIndex]);
-                if (isLongCommand(arg->value) || isShortCommand(arg->value)) {
-                    generateErrorText(DParseResult::NoValueWasPassedToOption, argument[i]);
-                    return DParseResult::NoValueWasPassedToOption;
-                }
-            }
-            arg->wasSet++;
-            break;
-        }
-        if (!commandFound) {
-            generateErrorText(DParseResult::InvalidOption, argument[i]);
-            return DParseResult::InvalidOption;
-        }
-    }
-    return DParseResult::ParseSuccessful;
+std::string_view DArgumentOption::GetValueView() const {
+    return valueView;
 }
 
-void DArgumentParser::SetAppInfo(const std::string &name, const std::string &version, const std::string &description) {
-    appName = name;
-    appVersion = version;
-    appDescription = description;
+DValueRange DArgumentOption::GetValues() const {
+    if (multipleValues)
+        return {values.data(), values.size()};
+    return {&valueView, wasSet > 0 && type == DArgumentOptionType::InputOption ? 1u : 0u};
 }
 
-void DArgumentParser::SetAppName(const std::string &name) {
-    appName = name;
+long long DArgumentOption::GetIntegerValue() const {
+    return integerValue;
 }
 
-void DArgumentParser::SetAppVersion(const std::string &version) {
-    appVersion = version;
+double DArgumentOption::GetFloatingPointValue() const {
+    return floatingPointValue;
 }
 
-void DArgumentParser::SetAppDescription(const std::string &description) {
-    appDescription = description;
+bool DArgumentOption::GetBooleanValue() const {
+    return booleanValue;
 }
 
-bool DArgumentParser::AddArgumentOption(DArgumentOption *dArgumentOption) {
-    if (!checkIfArgumentIsUnique(dArgumentOption))
-        return false;
-    return argumentOptions.insert(dArgumentOption).second;
+std::chrono::nanoseconds DArgumentOption::GetDurationValue() const {
+    return durationValue;
 }
 
-bool DArgumentParser::AddArgumentOption(std::unordered_set<DArgumentOption *> &&args) {
-    if (!checkIfAllArgumentsInListAreUnique(args))
-        return false;
-    argumentOptions.merge(args);
-    return true;
+unsigned long long DArgumentOption::GetByteSizeValue() const {
+    return byteSizeValue;
 }
 
-bool DArgumentParser::RemoveArgumentOption(DArgumentOption *argument) {
-    return argumentOptions.erase(argument);
-}
+//returned for commands that aren't part of the parser or schema, it's never set so it's never written to
+static const DArgumentOption unsetOption;
 
-void DArgumentParser::ClearArgumentOptions() {
-    argumentOptions.clear();
-}
+DArgumentParser::DArgumentParser(int argc, char **argv, std::string _appName, std::string _appVersion, std::string _appDescription) : DArgumentParser(argc, argv, std::pmr::get_default_resource(), std::move(_appName), std::move(_appVersion), std::move(_appDescription)) {}
 
-void DArgumentParser::AddPositionalArgument(std::string name, std::string description, std::string syntax) {
-    positionalArgs.emplace_back(std::move(name), std::move(description), std::move(syntax));
+DArgumentParser::DArgumentParser(int argc, char **argv, std::pmr::memory_resource *memoryResource, std::string _appName, std::string _appVersion, std::string _appDescription) :
+        argumentCount(argc),
+        argumentValues(argv),
+        allocationCounter(createAllocationCounter(memoryResource)),
+        storage(allocationCounter != nullptr ? allocationCounter.get() : memoryResource),
+        executableName(getExecutableName(argv[0]), storage),
+        appName(_appName, storage),
+        appVersion(_appVersion, storage),
+        appDescription(_appDescription, storage),
+        argumentOptions(storage),
+        longCommandIndex(storage),
+        environmentIndex(storage),
+        configFilePath(storage),
+        configEntries(storage),
+        positionalArgs(storage),
+        positionalArgsViews(storage),
+        errorText(storage),
+        sortedLongCommands(storage),
+        ambiguousCandidates(storage),
+        arguments(storage),
+        responseFiles(storage),
+        inheritedArgumentText(storage),
+        registrationErrorText(storage),
+        commandString(storage),
+        commandStringArguments(storage),
+        helpAndVersionOptionsLayout(storage),
+        normalOptionsLayout(storage),
+        subcommands(storage),
+        subcommandParsers(storage),
+        subcommandIndex(storage),
+        lazyCommandTokens(storage),
+        lazyResolvedOptions(storage),
+        lazyEnvironment(storage),
+        editEnvironment(storage),
+        editFallbackOptions(storage),
+        editedArguments(storage),
+        argumentJournal(storage),
+        optionSnapshots(storage),
+        argumentEdits(storage),
+        removedArguments(storage),
+        occurrences(storage),
+        suggestionTable(storage),
+        suggestionLengthStarts(storage),
+        suggestions(storage) {}
+
+DArgumentParser::AllocationCounter::AllocationCounter(std::pmr::memory_resource *_upstream) : upstream(_upstream) {}
+
+void *DArgumentParser::AllocationCounter::do_allocate(size_t bytes, size_t alignment) {
+    allocations++;
+    return upstream->allocate(bytes, alignment);
 }
 
-void DArgumentParser::ClearPositionalArgumets() {
-    positionalArgs.clear();
+void DArgumentParser::AllocationCounter::do_deallocate(void *pointer, size_t bytes, size_t alignment) {
+    upstream->deallocate(pointer, bytes, alignment);
 }
 
-int DArgumentParser::WasSet(char command) {
-    for (auto argument: argumentOptions)
-        if (argument->shortCommands.find(command) != argument->shortCommands.end())
-            return argument->wasSet;
-    return 0;
+bool DArgumentParser::AllocationCounter::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+    return this == &other;
 }
 
-int DArgumentParser::WasSet(const std::string &command) {
-    for (auto argument: argumentOptions)
-        if (argument->longCommands.find(command) != argument->longCommands.end())
-            return argument->wasSet;
-    return 0;
+std::unique_ptr<DArgumentParser::AllocationCounter> DArgumentParser::createAllocationCounter(std::pmr::memory_resource *memoryResource) {
+    if (!instrumentationEnabled)
+        return nullptr;
+    return std::make_unique<AllocationCounter>(memoryResource);
+}
+
+#ifdef DARGUMENTPARSER_INSTRUMENTATION
+/**
+ * Adds the time from its creation until its destruction to a phase of the statistics, leaving out the time added to excludedPhase in the meantime.
+ */
+class DArgumentParser::PhaseTimer {
+    using Phase = std::chrono::nanoseconds DParseStatistics::*;
+
+    DParseStatistics *statistics;
+    Phase phase;
+    Phase excludedPhase;
+    std::chrono::nanoseconds excludedBefore{0};
+    std::chrono::steady_clock::time_point start;
+
+public:
+    PhaseTimer(DParseStatistics *_statistics, Phase _phase, Phase _excludedPhase = nullptr) : statistics(_statistics), phase(_phase), excludedPhase(_excludedPhase) {
+        if (statistics == nullptr)
+            return;
+        if (excludedPhase != nullptr)
+            excludedBefore = statistics->*excludedPhase;
+        start = std::chrono::steady_clock::now();
+    }
+
+    PhaseTimer(const PhaseTimer &) = delete;
+
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+    ~PhaseTimer() {
+        if (statistics == nullptr)
+            return;
+        statistics->*phase += std::chrono::steady_clock::now() - start;
+        if (excludedPhase != nullptr)
+            statistics->*phase -= statistics->*excludedPhase - excludedBefore;
+    }
+};
+#else
+//without instrumentation the timer is empty and trivially destructible, so it doesn't even leave cleanup code behind in the parse loop
+class DArgumentParser::PhaseTimer {
+public:
+    PhaseTimer(DParseStatistics *, std::chrono::nanoseconds DParseStatistics::*, std::chrono::nanoseconds DParseStatistics::* = nullptr) {}
+};
+#endif
+
+static void countLookupProbes(DParseStatistics *statistics, size_t probes) {
+    if (instrumentationEnabled && statistics != nullptr)
+        statistics->lookupProbes += probes;
+}
+
+DParseStatistics &DParseStatistics::operator+=(const DParseStatistics &other) {
+    tokenizeTime += other.tokenizeTime;
+    lookupTime += other.lookupTime;
+    valueAssignmentTime += other.valueAssignmentTime;
+    helpGenerationTime += other.helpGenerationTime;
+    tokens += other.tokens;
+    lookupProbes += other.lookupProbes;
+    allocations += other.allocations;
+    errors += other.errors;
+    parses += other.parses;
+    return *this;
+}
+
+void DArgumentParser::beginStatistics() {
+    if (!instrumentationEnabled)
+        return;
+    currentStatistics = DParseStatistics();
+    currentStatistics.allocations = allocationCounter->allocations;
+}
+
+DParseResult DArgumentParser::finishStatistics(DParseResult result, bool isParse) {
+    if (!instrumentationEnabled)
+        return result;
+    currentStatistics.allocations = allocationCounter->allocations - currentStatistics.allocations;
+    if (isParse) {
+        currentStatistics.tokens = arguments.empty() ? 0 : arguments.size() - 1;
+        currentStatistics.errors = result != DParseResult::ParseSuccessful;
+        currentStatistics.parses = 1;
+    }
+    totalStatistics += currentStatistics;
+    if (statisticsObserver)
+        statisticsObserver(currentStatistics);
+    return result;
+}
+
+std::string_view DArgumentParser::getExecutableName(const char *execCall) {
+    std::string_view execName(execCall);
+    return execName.substr(execName.find_last_of('/') + 1);
+}
+
+DArgumentParser::ParseState::ParseState(int _argumentCount, char **_argumentValues, bool _expandResponseFiles, const std::pmr::vector<std::string_view> *_sortedLongCommands, std::pmr::vector<std::string_view> &_arguments, std::pmr::vector<DMappedFile> &_responseFiles, std::pmr::vector<std::string_view> &_positionalArgsViews, std::pmr::string &_errorText, std::pmr::vector<std::string_view> &_ambiguousCandidates) : argumentCount(_argumentCount), argumentValues(_argumentValues), expandResponseFiles(_expandResponseFiles), sortedLongCommands(_sortedLongCommands), arguments(_arguments), responseFiles(_responseFiles), positionalArgsViews(_positionalArgsViews), errorText(_errorText), ambiguousCandidates(_ambiguousCandidates) {}
+
+DArgumentParser::SubcommandEntry::SubcommandEntry(std::string_view _name, std::string_view _description, std::function<void(DArgumentParser &)> _factory, std::string_view parentExecutableName, std::pmr::memory_resource *memoryResource) : name(_name, memoryResource), description(_description, memoryResource), factory(std::move(_factory)), executableName(parentExecutableName, memoryResource) {
+    executableName += ' ';
+    executableName += name;
+}
+
+int DArgumentParser::calculateSizeOfOptionString(const DArgumentOption *arg) {
+    /** formula explanation:
+     * 2 * arg->shortCommands.size() -> adding the minus sign to a characters always leads to 2 characters, so we just need to multiply the amount of chars by 2
+     * arg->shortCommands.size() + arg->longCommands.size() -> the amount of spaces needed between commands, not reducing by 1 means we'll have one extra space total, but we can account for that when building the string and avoid branches.
+     * (arg->type == DArgumentOptionType::InputOption) * 8) -> if arg.type takes a value, we'll print "<value> " (8 characters) after it, because false/true resolves to 0/1, we can safely multiply by this comparison to avoid branching.
+     */
+    int size = (int) ((2 * arg->shortCommands.size()) + arg->shortCommands.size() + arg->longCommands.size() + ((arg->type == DArgumentOptionType::InputOption) * 8));//strlen("<value> ") == 8
+    for (const auto &longCommand: arg->longCommands)
+        /** formula explanation:
+         * 2 + longCommand.size() -> size of string plus two minus signs characters
+         */
+        size += (int) (2 + longCommand.size());
+    return size;
+}
+
+/**
+ * Produces the line of an option in the help text as a sequence of pieces, without building the line itself.
+ * <br>Every piece points to memory that outlives the help rendering (the option's commands and description or constant strings), so sinks are free to hold them until they are flushed.
+ */
+class DArgumentParser::OptionLine {
+    enum class Stage : unsigned char {
+        Prefix, ShortMinus, ShortCommand, ShortSpace, LongMinus, LongCommand, LongSpace, Value, Padding, DescriptionSeparator, Description, NewLine, End
+    };
+
+    const DArgumentOption *option;
+    int padding;
+    Stage stage = Stage::Prefix;
+    std::set<char>::const_iterator shortIterator;
+    std::set<std::string>::const_iterator longIterator;
+
+public:
+    OptionLine(const DArgumentOption *_option, int columnSize) : option(_option), padding(columnSize - calculateSizeOfOptionString(_option)), shortIterator(_option->shortCommands.begin()), longIterator(_option->longCommands.begin()) {}
+
+    /**
+     * @return Returns the next piece of the line, or an empty view once the line is over.
+     */
+    std::string_view Next() {
+        while (true) {
+            switch (stage) {
+                case Stage::Prefix:
+                    stage = Stage::ShortMinus;
+                    return "   ";
+                case Stage::ShortMinus:
+                    if (shortIterator == option->shortCommands.end()) {
+                        stage = Stage::LongMinus;
+                        continue;
+                    }
+                    stage = Stage::ShortCommand;
+                    return "-";
+                case Stage::ShortCommand:
+                    stage = Stage::ShortSpace;
+                    return {&*shortIterator, 1};
+                case Stage::ShortSpace:
+                    ++shortIterator;
+                    stage = Stage::ShortMinus;
+                    return " ";
+                case Stage::LongMinus:
+                    if (longIterator == option->longCommands.end()) {
+                        stage = Stage::Value;
+                        continue;
+                    }
+                    stage = Stage::LongCommand;
+                    return "--";
+                case Stage::LongCommand:
+                    stage = Stage::LongSpace;
+                    if (longIterator->empty())
+                        continue;
+                    return *longIterator;
+                case Stage::LongSpace:
+                    ++longIterator;
+                    stage = Stage::LongMinus;
+                    return " ";
+                case Stage::Value:
+                    stage = Stage::Padding;
+                    if (option->type != DArgumentOptionType::InputOption)
+                        continue;
+                    return argOptionTakesValueString;
+                case Stage::Padding: {
+                    if (padding <= 0) {
+                        stage = Stage::DescriptionSeparator;
+                        continue;
+                    }
+                    int size = std::min(padding, (int) paddingSpaces.size());
+                    padding -= size;
+                    return paddingSpaces.substr(0, size);
+                }
+                case Stage::DescriptionSeparator:
+                    stage = option->description.empty() ? Stage::NewLine : Stage::Description;
+                    if (stage == Stage::NewLine)
+                        continue;
+                    return "  ";
+                case Stage::Description:
+                    stage = Stage::NewLine;
+                    return option->description;
+                case Stage::NewLine:
+                    stage = Stage::End;
+                    return "\n";
+                default:
+                    return {};
+            }
+        }
+    }
+};
+
+bool DArgumentParser::optionLineIsLess(const DArgumentOption *first, const DArgumentOption *second, int columnSize) {
+    OptionLine firstLine(first, columnSize), secondLine(second, columnSize);
+    std::string_view firstPiece = firstLine.Next(), secondPiece = secondLine.Next();
+    while (!firstPiece.empty() && !secondPiece.empty()) {
+        size_t size = std::min(firstPiece.size(), secondPiece.size());
+        int comparison = firstPiece.substr(0, size).compare(secondPiece.substr(0, size));
+        if (comparison != 0)
+            return comparison < 0;
+        firstPiece.remove_prefix(size);
+        secondPiece.remove_prefix(size);
+        if (firstPiece.empty())
+            firstPiece = firstLine.Next();
+        if (secondPiece.empty())
+            secondPiece = secondLine.Next();
+    }
+    return firstPiece.empty() && !secondPiece.empty();
+}
+
+int DArgumentParser::layoutOptionsSubSection(std::pmr::vector<DArgumentOption *> &args) {
+    int optionCommandsColSize = 0;
+    for (auto arg: args)
+        optionCommandsColSize = std::max(optionCommandsColSize, calculateSizeOfOptionString(arg));
+    std::sort(args.begin(), args.end(), [optionCommandsColSize](const DArgumentOption *first, const DArgumentOption *second) {
+        return optionLineIsLess(first, second, optionCommandsColSize);
+    });
+    return optionCommandsColSize;
+}
+
+void DArgumentParser::writeOptionsSubSection(DHelpSink &sink, const std::pmr::vector<DArgumentOption *> &args, int columnSize, const char *openingString) {
+    if (args.empty())
+        return;
+    sink.Write(openingString);
+    for (auto arg: args) {
+        OptionLine line(arg, columnSize);
+        for (std::string_view piece = line.Next(); !piece.empty(); piece = line.Next())
+            sink.Write(piece);
+    }
+}
+
+bool DArgumentParser::isLongCommand(std::string_view argument) {
+    return (argument.size() > longCommandStartPos && argument[0] == minusSign && argument[1] == minusSign);
+}
+
+bool DArgumentParser::isShortCommand(std::string_view argument) {
+    return (argument.size() > shortCommandStartPos && argument[0] == minusSign && argument[1] != minusSign);
+}
+
+bool DArgumentParser::checkIfArgumentIsUnique(DArgumentOption *dArgumentOption, const std::unordered_set<DArgumentOption *> *batch) {
+    registrationErrorText.clear();
+    if (argumentOptions.find(dArgumentOption) != argumentOptions.end()) {
+        registrationErrorText += "Option was already added";
+        return false;
+    }
+    if (dArgumentOption->shortCommands.empty() && dArgumentOption->longCommands.empty()) {
+        registrationErrorText += "Option has no commands";
+        return false;
+    }
+    //the options added before (including the ones of the same batch) are all in the command index, so only the option's own commands need to be looked up
+    for (auto shortCommand: dArgumentOption->shortCommands) {
+        DArgumentOption *owner = shortCommandIndex[(unsigned char) shortCommand];
+        if (owner == nullptr)
+            continue;
+        registrationErrorText += "Command -";
+        registrationErrorText += shortCommand;
+        registrationErrorText += batch != nullptr && batch->find(owner) != batch->end() ? " is used by more than one of the options being added" : " is already used by another option";
+        return false;
+    }
+    for (const auto &longCommand: dArgumentOption->longCommands) {
+        auto iterator = longCommandIndex.find(longCommand);
+        if (iterator == longCommandIndex.end())
+            continue;
+        registrationErrorText += "Command --";
+        registrationErrorText += longCommand;
+        registrationErrorText += batch != nullptr && batch->find(iterator->second) != batch->end() ? " is used by more than one of the options being added" : " is already used by another option";
+        return false;
+    }
+    auto iterator = environmentIndex.find(dArgumentOption->environmentVariable);
+    if (iterator != environmentIndex.end()) {
+        registrationErrorText += "Environment variable ";
+        registrationErrorText += dArgumentOption->environmentVariable;
+        registrationErrorText += batch != nullptr && batch->find(iterator->second) != batch->end() ? " is used by more than one of the options being added" : " is already used by another option";
+        return false;
+    }
+    return true;
+}
+
+void DArgumentParser::addToCommandIndex(DArgumentOption *dArgumentOption) {
+    for (auto shortCommand: dArgumentOption->shortCommands)
+        shortCommandIndex[(unsigned char) shortCommand] = dArgumentOption;
+    for (const auto &longCommand: dArgumentOption->longCommands)
+        longCommandIndex.emplace(longCommand, dArgumentOption);
+    if (!dArgumentOption->environmentVariable.empty())
+        environmentIndex.emplace(dArgumentOption->environmentVariable, dArgumentOption);
+}
+
+void DArgumentParser::pruneCommandIndex() {
+    //entries are found by the option they point to, the option's commands may no longer be the ones it was indexed with
+    auto isRemoved = [this](DArgumentOption *owner) { return owner != nullptr && argumentOptions.find(owner) == argumentOptions.end(); };
+    for (auto &owner: shortCommandIndex)
+        if (isRemoved(owner))
+            owner = nullptr;
+    for (auto *index: {&longCommandIndex, &environmentIndex})
+        for (auto iterator = index->begin(); iterator != index->end();)
+            iterator = isRemoved(iterator->second) ? index->erase(iterator) : std::next(iterator);
+}
+
+bool DArgumentParser::updateHelpLayout() {
+    size_t revision = optionsRevision();
+    if (!helpLayoutIsDirty && revision == helpLayoutOptionsRevision)
+        return false;
+    helpLayoutIsDirty = false;
+    helpLayoutOptionsRevision = revision;
+    //WriteHelp also updates the layout, so the cached help text keeps its own flag
+    helpTextIsDirty = true;
+    helpAndVersionOptionsLayout.clear();
+    normalOptionsLayout.clear();
+    for (auto arg: argumentOptions)
+        if (arg->type == DArgumentOptionType::HelpOption || arg->type == DArgumentOptionType::VersionOption)
+            helpAndVersionOptionsLayout.push_back(arg);
+        else
+            normalOptionsLayout.push_back(arg);
+    helpAndVersionOptionsColumnSize = layoutOptionsSubSection(helpAndVersionOptionsLayout);
+    normalOptionsColumnSize = layoutOptionsSubSection(normalOptionsLayout);
+    positionalArgsColumnSize = 0;
+    for (const auto &arg: positionalArgs)
+        positionalArgsColumnSize = std::max(positionalArgsColumnSize, calculateSizeOfArgumentString(arg));
+    subcommandsColumnSize = 0;
+    for (const auto &subcommand: subcommands)
+        subcommandsColumnSize = std::max(subcommandsColumnSize, (int) subcommand.name.size());
+    return true;
+}
+
+void DArgumentParser::writeUsageSection(DHelpSink &sink) const {
+    sink.Write("Usage: ");
+    sink.Write(executableName);
+    if (!argumentOptions.empty())
+        sink.Write(" [options]");
+    for (const auto &posArg: positionalArgs) {
+        if (std::get<2>(posArg).empty()) {
+            sink.Write(" [");
+            sink.Write(std::get<0>(posArg));
+            sink.Write("]");
+            continue;
+        }
+        sink.Write(" ");
+        sink.Write(std::get<2>(posArg));
+    }
+    if (!subcommands.empty())
+        sink.Write(" <command> [<args>]");
+    sink.Write("\n");
+}
+
+void DArgumentParser::writeDescriptionSection(DHelpSink &sink) const {
+    if (appDescription.empty())
+        return;
+    sink.Write("\n");
+    sink.Write(appDescription);
+    sink.Write("\n");
+}
+
+int DArgumentParser::calculateSizeOfArgumentString(const std::tuple<std::pmr::string, std::pmr::string, std::pmr::string> &arg) {
+    /** formula explanation:
+     * std::get<0>(arg).size() + 2 -> size of string plus size of 2 characters
+     */
+    return (int) (std::get<2>(arg).empty() ? (std::get<0>(arg).size() + 2) : std::get<2>(arg).size());
+}
+
+void DArgumentParser::writePositionalArgsSection(DHelpSink &sink) const {
+    if (positionalArgs.empty())
+        return;
+    sink.Write("\nArguments:\n");
+    for (const auto &arg: positionalArgs) {
+        sink.Write("   ");
+        if (!std::get<2>(arg).empty())
+            sink.Write(std::get<2>(arg));
+        else {
+            sink.Write("[");
+            sink.Write(std::get<0>(arg));
+            sink.Write("]");
+        }
+        for (int padding = positionalArgsColumnSize - calculateSizeOfArgumentString(arg); padding > 0; padding -= (int) paddingSpaces.size())
+            sink.Write(paddingSpaces.substr(0, std::min(padding, (int) paddingSpaces.size())));
+        sink.Write("   ");
+        sink.Write(std::get<1>(arg));
+        sink.Write("\n");
+    }
+}
+
+void DArgumentParser::writeSubcommandsSection(DHelpSink &sink) const {
+    if (subcommands.empty())
+        return;
+    sink.Write("\nCommands:\n");
+    for (const auto &subcommand: subcommands) {
+        sink.Write("   ");
+        sink.Write(subcommand.name);
+        for (int padding = subcommandsColumnSize - (int) subcommand.name.size(); padding > 0; padding -= (int) paddingSpaces.size())
+            sink.Write(paddingSpaces.substr(0, std::min(padding, (int) paddingSpaces.size())));
+        sink.Write("   ");
+        sink.Write(subcommand.description);
+        sink.Write("\n");
+    }
+}
+
+std::string DArgumentParser::FormatErrorText(DParseResult error, std::string_view command) {
+    std::string text;
+    writeErrorText(text, error, command);
+    return text;
+}
+
+std::string DArgumentParser::FormatErrorText(DParseResult error, char command) {
+    std::string text;
+    writeErrorText(text, error, command);
+    return text;
+}
+
+size_t DArgumentParser::optionsRevision() const {
+    size_t revision = 0;
+    for (auto arg: argumentOptions)
+        revision += arg->revision;
+    return revision;
+}
+
+void DArgumentParser::resetParseState() {
+    arguments.clear();
+    responseFiles.clear();
+    positionalArgsViews.clear();
+    positionalArgsValues.clear();
+    errorText.clear();
+    ambiguousCandidates.clear();
+    occurrences.clear();
+    suggestions.clear();
+    selectedSubcommand = nullptr;
+    lazyParsePending = false;
+    isEditingArguments = false;
+}
+
+void DArgumentParser::resetParsedValues() {
+    resetParseState();
+    for (auto arg: argumentOptions)
+        arg->resetValue();
+}
+
+const std::pmr::vector<std::string_view> &DArgumentParser::sortedLongCommandTable() {
+    if (!sortedLongCommandsIsDirty)
+        return sortedLongCommands;
+    sortedLongCommandsIsDirty = false;
+    sortedLongCommands.clear();
+    sortedLongCommands.reserve(longCommandIndex.size());
+    for (const auto &entry: longCommandIndex)
+        sortedLongCommands.push_back(entry.first);
+    std::sort(sortedLongCommands.begin(), sortedLongCommands.end());
+    return sortedLongCommands;
+}
+
+void DArgumentParser::updateSuggestionTable() {
+    if (!suggestionTableIsDirty)
+        return;
+    suggestionTableIsDirty = false;
+    suggestionTable.clear();
+    for (auto command: sortedLongCommandTable())
+        suggestionTable.push_back({command, characterMask(command)});
+    std::stable_sort(suggestionTable.begin(), suggestionTable.end(), [](const SuggestionEntry &first, const SuggestionEntry &second) { return first.command.size() < second.command.size(); });
+    size_t longest = suggestionTable.empty() ? 0 : suggestionTable.back().command.size();
+    suggestionLengthStarts.assign(longest + 2, 0);
+    for (size_t size = 0, index = 0; size < suggestionLengthStarts.size(); size++) {
+        while (index < suggestionTable.size() && suggestionTable[index].command.size() < size)
+            index++;
+        suggestionLengthStarts[size] = (unsigned) index;
+    }
+}
+
+DParseResult DArgumentParser::suggestCommands(DParseResult result, ParseState &state) {
+    suggestions.clear();
+    std::string_view command = state.invalidCommand;
+    if (result != DParseResult::InvalidOption || command.empty() || command.size() > maxSuggestedCommandSize)
+        return result;
+    updateSuggestionTable();
+    std::array<unsigned long long, 256> patternMasks{};
+    for (size_t index = 0; index < command.size(); index++)
+        patternMasks[(unsigned char) command[index]] |= 1ULL << index;
+    unsigned long long commandCharacters = characterMask(command);
+    //commands whose size differs by more than the distance allowed can't be close enough, so only the sizes around the command's are compared
+    size_t maxDistance = std::clamp<size_t>((command.size() + 2) / 4, 1, maxSuggestionDistance);
+    size_t lastSize = suggestionLengthStarts.size() - 1;
+    size_t first = suggestionLengthStarts[std::min(command.size() - std::min(command.size(), maxDistance), lastSize)];
+    size_t last = suggestionLengthStarts[std::min(command.size() + maxDistance + 1, lastSize)];
+    countLookupProbes(state.statistics, last - first);
+    std::array<std::pair<size_t, std::string_view>, maxSuggestions> closest;
+    size_t closestCount = 0;
+    for (size_t index = first; index < last; index++) {
+        const SuggestionEntry &entry = suggestionTable[index];
+        //every character only one of them has takes at least an edit, and an edit can fix one on each side
+        if (std::max(std::bitset<64>(commandCharacters & ~entry.characters).count(), std::bitset<64>(entry.characters & ~commandCharacters).count()) > maxDistance)
+            continue;
+        std::pair<size_t, std::string_view> candidate{boundedEditDistance(patternMasks, command.size(), entry.command, maxDistance), entry.command};
+        if (candidate.first > maxDistance || (closestCount == maxSuggestions && !(candidate < closest[closestCount - 1])))
+            continue;
+        size_t position = closestCount < maxSuggestions ? closestCount++ : closestCount - 1;
+        for (; position > 0 && candidate < closest[position - 1]; position--)
+            closest[position] = closest[position - 1];
+        closest[position] = candidate;
+        //once full, only commands at most as far as the farthest one kept can replace it
+        if (closestCount == maxSuggestions)
+            maxDistance = closest[closestCount - 1].first;
+    }
+    for (size_t index = 0; index < closestCount; index++)
+        suggestions.push_back(closest[index].second);
+    if (!suggestions.empty())
+        writeSuggestions(state.errorText, suggestions);
+    return result;
+}
+
+const std::pmr::vector<std::string_view> *DArgumentParser::updateSortedLongCommands() {
+    return allowAbbreviations ? &sortedLongCommandTable() : nullptr;
+}
+
+template<typename CommandIndex>
+DArgumentOption *DArgumentParser::findAbbreviation(const CommandIndex &commandIndex, std::string_view abbreviation, ParseState &state) {
+    if (abbreviation.empty())
+        return nullptr;
+    const auto &commands = *state.sortedLongCommands;
+    auto first = std::lower_bound(commands.begin(), commands.end(), abbreviation);
+    auto last = std::partition_point(first, commands.end(), [abbreviation](std::string_view command) { return command.substr(0, abbreviation.size()) == abbreviation; });
+    countLookupProbes(state.statistics, last - first);
+    DArgumentOption *arg = nullptr;
+    for (auto iterator = first; iterator != last; ++iterator) {
+        DArgumentOption *candidate = commandIndex.findLongCommand(*iterator);
+        if (arg != nullptr && candidate != arg) {
+            state.ambiguousCandidates.assign(first, last);
+            return nullptr;
+        }
+        arg = candidate;
+    }
+    return arg;
+}
+
+DArgumentOption *DArgumentParser::findLongCommand(std::string_view command) const {
+    auto iterator = longCommandIndex.find(command);
+    return iterator == longCommandIndex.end() ? nullptr : iterator->second;
+}
+
+DArgumentOption *DArgumentParser::findShortCommand(char command) const {
+    return shortCommandIndex[(unsigned char) command];
+}
+
+DParseResult DArgumentParser::collectArguments(ParseState &state) {
+    state.arguments.reserve(state.argumentCount);
+    if (state.argumentCount > 0)
+        state.arguments.emplace_back(state.argumentValues[0]);
+    for (int index = 1; index < state.argumentCount; index++) {
+        DParseResult parseResult = collectArgument(state.argumentValues[index], state);
+        if (parseResult != DParseResult::ParseSuccessful)
+            return parseResult;
+    }
+    return DParseResult::ParseSuccessful;
+}
+
+DParseResult DArgumentParser::collectArgument(std::string_view argument, ParseState &state) {
+    if (state.expandResponseFiles && argument.size() > 1 && argument[0] == responseFileSign)
+        return expandResponseFile(argument.substr(1), 0, state);
+    state.arguments.push_back(argument);
+    return DParseResult::ParseSuccessful;
+}
+
+DParseResult DArgumentParser::expandResponseFile(std::string_view path, int depth, ParseState &state) {
+    auto &arguments = state.arguments;
+    DMappedFile file;
+    std::pmr::string pathString(path, arguments.get_allocator());
+    if (depth == maxResponseFileDepth || !file.Open(pathString.c_str())) {
+        writeErrorText(state.errorText, DParseResult::InvalidResponseFile, path);
+        return DParseResult::InvalidResponseFile;
+    }
+    size_t firstArgument = arguments.size();
+    DCommandTokenizer::TokenizeInPlace(file.Data(), file.Data() + file.Size(), arguments);
+    state.responseFiles.push_back(std::move(file));
+    for (size_t index = firstArgument; index < arguments.size(); index++) {
+        std::string_view argument = arguments[index];
+        if (argument.size() < 2 || argument[0] != responseFileSign)
+            continue;
+        //nested files are spliced in place, so the arguments that follow are moved out and appended back after it
+        std::pmr::vector<std::string_view> following(arguments.begin() + (long) index + 1, arguments.end(), arguments.get_allocator());
+        arguments.resize(index);
+        DParseResult parseResult = expandResponseFile(argument.substr(1), depth + 1, state);
+        if (parseResult != DParseResult::ParseSuccessful)
+            return parseResult;
+        index = arguments.size() - 1;
+        arguments.insert(arguments.end(), following.begin(), following.end());
+    }
+    return DParseResult::ParseSuccessful;
+}
+
+bool DArgumentParser::assignValue(DArgumentOption *arg, std::string_view value, ParseState &state) {
+    PhaseTimer timer(state.statistics, &DParseStatistics::valueAssignmentTime);
+    return arg->setValue(value);
+}
+
+template<typename CommandIndex>
+DParseResult DArgumentParser::parseArguments(const CommandIndex &commandIndex, ParseState &state) {
+    DParseResult parseResult;
+    {
+        PhaseTimer timer(state.statistics, &DParseStatistics::tokenizeTime);
+        parseResult = collectArguments(state);
+    }
+    if (parseResult != DParseResult::ParseSuccessful)
+        return parseResult;
+    return parseCollectedArguments(commandIndex, state);
+}
+
+template<typename CommandIndex>
+DParseResult DArgumentParser::parseCollectedArguments(const CommandIndex &commandIndex, ParseState &state) {
+    DParseResult parseResult;
+    int argumentsSize = (int) state.arguments.size();
+    if (argumentsSize < 2)
+        return DParseResult::ParseSuccessful;
+    PhaseTimer timer(state.statistics, &DParseStatistics::lookupTime, &DParseStatistics::valueAssignmentTime);
+    state.positionalArgsViews.reserve(argumentsSize - 1);
+    for (int index = 1; index < argumentsSize; index++) {
+        std::string_view currArg = state.arguments[index];
+        if (isLongCommand(currArg)) {
+            parseResult = parseLongCommand(commandIndex, currArg, index, state);
+            if (parseResult != DParseResult::ParseSuccessful)
+                return parseResult;
+            continue;
+        }
+        if (isShortCommand(currArg)) {
+            parseResult = parseShortCommand(commandIndex, currArg, index, state);
+            if (parseResult != DParseResult::ParseSuccessful)
+                return parseResult;
+            continue;
+        }
+        state.positionalArgsViews.push_back(currArg);
+        if (state.stopAtFirstPositional) {
+            state.firstUnparsedArgument = index + 1;
+            break;
+        }
+    }
+    return DParseResult::ParseSuccessful;
+}
+
+template<typename CommandIndex>
+DParseResult DArgumentParser::parseLongCommand(const CommandIndex &commandIndex, std::string_view argument, int &currentIndex, ParseState &state) {
+    size_t posOfEqualSign = argument.find_first_of(equalSign, longCommandStartPos);
+    std::string_view command = argument.substr(longCommandStartPos, posOfEqualSign - longCommandStartPos);
+    DArgumentOption *arg = commandIndex.findLongCommand(command);
+    countLookupProbes(state.statistics, 1);
+    if (arg == nullptr && state.sortedLongCommands != nullptr)
+        arg = findAbbreviation(commandIndex, command, state);
+    if (arg == nullptr && !state.ambiguousCandidates.empty()) {
+        writeErrorText(state.errorText, DParseResult::AmbiguousOption, command);
+        writeAmbiguousCandidates(state.errorText, state.ambiguousCandidates);
+        return DParseResult::AmbiguousOption;
+    }
+    if (arg == nullptr) {
+        writeErrorText(state.errorText, DParseResult::InvalidOption, command);
+        state.invalidCommand = command;
+        return DParseResult::InvalidOption;
+    }
+    if (arg->type != DArgumentOptionType::InputOption && posOfEqualSign != std::string_view::npos) {
+        writeErrorText(state.errorText, DParseResult::ValuePassedToOptionThatDoesNotTakeValue, command);
+        return DParseResult::ValuePassedToOptionThatDoesNotTakeValue;
+    }
+    if (arg->type == DArgumentOptionType::InputOption) {
+        std::string_view value;
+        if (posOfEqualSign == std::string_view::npos) {
+            if (++currentIndex == (int) state.arguments.size()) {
+                writeErrorText(state.errorText, DParseResult::NoValueWasPassedToOption, command);
+                return DParseResult::NoValueWasPassedToOption;
+            }
+            value = state.arguments[currentIndex];
+            if (isLongCommand(value) || isShortCommand(value)) {
+                writeErrorText(state.errorText, DParseResult::NoValueWasPassedToOption, command);
+                return DParseResult::NoValueWasPassedToOption;
+            }
+        } else {
+            if (argument[posOfEqualSign] == argument[argument.size() - 1]) {
+                writeErrorText(state.errorText, DParseResult::NoValueWasPassedToOption, command);
+                return DParseResult::NoValueWasPassedToOption;
+            }
+            value = argument.substr(posOfEqualSign + 1);
+        }
+        if (!assignValue(arg, value, state)) {
+            writeErrorText(state.errorText, DParseResult::InvalidValue, command);
+            return DParseResult::InvalidValue;
+        }
+        if (arg->multipleValues && state.occurrences != nullptr)
+            state.occurrences->push_back({arg, value});
+    }
+    arg->wasSet++;
+    arg->valueSource = DValueSource::CommandLine;
+    arg->writeBinding();
+    return DParseResult::ParseSuccessful;
+}
+
+template<typename CommandIndex>
+DParseResult DArgumentParser::parseShortCommand(const CommandIndex &commandIndex, std::string_view argument, int &currentIndex, ParseState &state) {
+    countLookupProbes(state.statistics, argument.size() - 1);
+    for (int i = 1; i < (int) argument.size(); i++) {
+        DArgumentOption *arg = commandIndex.findShortCommand(argument[i]);
+        if (arg == nullptr) {
+            writeErrorText(state.errorText, DParseResult::InvalidOption, argument[i]);
+            return DParseResult::InvalidOption;
+        }
+        if (arg->type == DArgumentOptionType::InputOption && argument.size() > 2) {
+            writeErrorText(state.errorText, DParseResult::OptionsThatTakesValueNeedsToBeSetSeparately, argument[i]);
+            return DParseResult::OptionsThatTakesValueNeedsToBeSetSeparately;
+        }
+        if (arg->type == DArgumentOptionType::InputOption) {
+            if (++currentIndex == (int) state.arguments.size()) {
+                writeErrorText(state.errorText, DParseResult::NoValueWasPassedToOption, argument[i]);
+                return DParseResult::NoValueWasPassedToOption;
+            }
+            std::string_view value = state.arguments[currentIndex];
+            if (isLongCommand(value) || isShortCommand(value)) {
+                writeErrorText(state.errorText, DParseResult::NoValueWasPassedToOption, argument[i]);
+                return DParseResult::NoValueWasPassedToOption;
+            }
+            if (!assignValue(arg, value, state)) {
+                writeErrorText(state.errorText, DParseResult::InvalidValue, argument[i]);
+                return DParseResult::InvalidValue;
+            }
+            if (arg->multipleValues && state.occurrences != nullptr)
+                state.occurrences->push_back({arg, value});
+        }
+        arg->wasSet++;
+        arg->valueSource = DValueSource::CommandLine;
+        arg->writeBinding();
+    }
+    return DParseResult::ParseSuccessful;
+}
+
+template<typename FindEnvironmentVariable>
+DParseResult DArgumentParser::parseEnvironment(char **environmentVariables, const FindEnvironmentVariable &findEnvironmentVariable, ParseState &state) {
+    for (char **variable = environmentVariables; *variable != nullptr; ++variable) {
+        std::string_view entry(*variable);
+        size_t posOfEqualSign = entry.find(equalSign);
+        if (posOfEqualSign == std::string_view::npos || posOfEqualSign + 1 == entry.size())
+            continue;
+        DArgumentOption *arg = findEnvironmentVariable(entry.substr(0, posOfEqualSign));
+        countLookupProbes(state.statistics, 1);
+        if (arg == nullptr || arg->wasSet > 0)
+            continue;
+        std::string_view value = entry.substr(posOfEqualSign + 1);
+        bool isEnabled = true;
+        bool isValid = arg->type == DArgumentOptionType::InputOption ? assignValue(arg, value, state) : convertBoolean(value, isEnabled);
+        if (!isValid) {
+            writeEnvironmentErrorText(state.errorText, entry.substr(0, posOfEqualSign));
+            return DParseResult::InvalidValue;
+        }
+        //a false variable still takes precedence over the config file, the option just stays unset
+        arg->wasSet = isEnabled ? 1 : 0;
+        arg->valueSource = DValueSource::Environment;
+        arg->writeBinding();
+    }
+    return DParseResult::ParseSuccessful;
+}
+
+DParseResult DArgumentParser::parseEnvironment(ParseState &state, char **environmentVariables) {
+    if (environmentIndex.empty())
+        return DParseResult::ParseSuccessful;
+    return parseEnvironment(environmentVariables, [this](std::string_view name) {
+        auto iterator = environmentIndex.find(name);
+        return iterator == environmentIndex.end() ? nullptr : iterator->second;
+    }, state);
+}
+
+DParseResult DArgumentParser::parseConfigFile(ParseState &state, const DArgumentOption *onlyOption) {
+    for (const auto &entry: configEntries) {
+        DArgumentOption *arg = findLongCommand(entry.key);
+        countLookupProbes(state.statistics, 1);
+        if (arg == nullptr) {
+            writeConfigErrorText(state.errorText, DParseResult::InvalidOption, entry.key, configFilePath);
+            state.invalidCommand = entry.key;
+            return DParseResult::InvalidOption;
+        }
+        if (onlyOption != nullptr && arg != onlyOption)
+            continue;
+        if (arg->valueSource != DValueSource::NotSet && arg->valueSource != DValueSource::ConfigFile)
+            continue;
+        bool isEnabled = true;
+        if (arg->type == DArgumentOptionType::InputOption) {
+            if (!entry.hasValue) {
+                writeConfigErrorText(state.errorText, DParseResult::NoValueWasPassedToOption, entry.key, configFilePath);
+                return DParseResult::NoValueWasPassedToOption;
+            }
+            if (!assignValue(arg, entry.value, state)) {
+                writeConfigErrorText(state.errorText, DParseResult::InvalidValue, entry.key, configFilePath);
+                return DParseResult::InvalidValue;
+            }
+        } else if (entry.hasValue && !convertBoolean(entry.value, isEnabled)) {
+            writeConfigErrorText(state.errorText, DParseResult::InvalidValue, entry.key, configFilePath);
+            return DParseResult::InvalidValue;
+        }
+        //a later entry turning the option off overrides an earlier one
+        if (!isEnabled) {
+            arg->resetValue();
+            continue;
+        }
+        arg->wasSet = 1;
+        arg->valueSource = DValueSource::ConfigFile;
+        arg->writeBinding();
+    }
+    return DParseResult::ParseSuccessful;
+}
+
+DParseResult DArgumentParser::parseFallbackSources(ParseState &state, char **environmentVariables) {
+    DParseResult parseResult = parseEnvironment(state, environmentVariables != nullptr ? environmentVariables : environment != nullptr ? environment : environ);
+    if (parseResult != DParseResult::ParseSuccessful || configEntries.empty())
+        return parseResult;
+    return parseConfigFile(state);
+}
+
+/**
+ * Resolves the commands of a lazy parse for a single option, every other option is replaced by a scratch option of the same type, so its values are still skipped over without touching the option itself.
+ */
+class DArgumentParser::LazyCommandIndex {
+    const DArgumentParser &parser;
+    DArgumentOption *target;
+    mutable DArgumentOption normalScratch{DArgumentOptionType::NormalOption, std::string()};
+    mutable DArgumentOption inputScratch{DArgumentOptionType::InputOption, std::string()};
+
+    DArgumentOption *replaceOthers(DArgumentOption *arg) const {
+        if (arg == nullptr || arg == target)
+            return arg;
+        return arg->type == DArgumentOptionType::InputOption ? &inputScratch : &normalScratch;
+    }
+
+public:
+    LazyCommandIndex(const DArgumentParser &_parser, DArgumentOption *_target) : parser(_parser), target(_target) {}
+
+    DArgumentOption *findLongCommand(std::string_view command) const {
+        return replaceOthers(parser.findLongCommand(command));
+    }
+
+    DArgumentOption *findShortCommand(char command) const {
+        return replaceOthers(parser.findShortCommand(command));
+    }
+};
+
+void DArgumentParser::resolveLazily(DArgumentOption *arg) {
+    if (!lazyParsePending || !lazyResolvedOptions.insert(arg).second)
+        return;
+    arg->resetValue();
+    //errors only go into scratch storage, Validate is the one reporting them
+    auto allocator = arguments.get_allocator();
+    std::pmr::vector<std::string_view> positionalArgsScratch(allocator), ambiguousCandidatesScratch(allocator);
+    std::pmr::string errorTextScratch(allocator);
+    ParseState state{argumentCount, argumentValues, false, updateSortedLongCommands(), arguments, responseFiles, positionalArgsScratch, errorTextScratch, ambiguousCandidatesScratch};
+    LazyCommandIndex commandIndex(*this, arg);
+    //the commands are compared with the option's own commands first, only the ones that can belong to it go through the index
+    auto mayBelongToOption = [this, arg](std::string_view argument) {
+        if (!isLongCommand(argument))
+            return std::any_of(argument.begin() + shortCommandStartPos, argument.end(), [this, arg](char command) { return shortCommandIndex[(unsigned char) command] == arg; });
+        std::string_view command = argument.substr(longCommandStartPos, argument.find(equalSign, longCommandStartPos) - longCommandStartPos);
+        return std::any_of(arg->longCommands.begin(), arg->longCommands.end(), [this, command](const std::string &longCommand) {
+            return allowAbbreviations ? std::string_view(longCommand).substr(0, command.size()) == command : longCommand == command;
+        });
+    };
+    for (int index: lazyCommandTokens) {
+        std::string_view argument = arguments[index];
+        if (!mayBelongToOption(argument))
+            continue;
+        int currentIndex = index;
+        if (isLongCommand(argument))
+            parseLongCommand(commandIndex, argument, currentIndex, state);
+        else
+            parseShortCommand(commandIndex, argument, currentIndex, state);
+        ambiguousCandidatesScratch.clear();
+    }
+    if (arg->wasSet > 0)
+        return;
+    if (!arg->environmentVariable.empty()) {
+        //the whole environment is only gone through by the first query, the following ones only see the variables of the options
+        if (lazyEnvironment.empty())
+            filterEnvironment(lazyEnvironment);
+        parseEnvironment(lazyEnvironment.data(), [arg](std::string_view name) {
+            return name == arg->environmentVariable ? arg : nullptr;
+        }, state);
+    }
+    if (!configEntries.empty())
+        parseConfigFile(state, arg);
+}
+
+void DArgumentParser::filterEnvironment(std::pmr::vector<char *> &entries) const {
+    entries.clear();
+    for (char **variable = environment != nullptr ? environment : environ; !environmentIndex.empty() && *variable != nullptr; ++variable) {
+        std::string_view entry(*variable);
+        if (environmentIndex.find(entry.substr(0, entry.find(equalSign))) != environmentIndex.end())
+            entries.push_back(*variable);
+    }
+    entries.push_back(nullptr);
+}
+
+/**
+ * Resolves the commands of an edited argument, recording a snapshot of every option it finds (once per argument) before the parse changes it.
+ */
+class DArgumentParser::JournalCommandIndex {
+    DArgumentParser &parser;
+    size_t firstSnapshot = 0;
+
+    DArgumentOption *record(DArgumentOption *arg) const {
+        if (arg == nullptr)
+            return nullptr;
+        auto &snapshots = parser.optionSnapshots;
+        if (std::none_of(snapshots.begin() + (long) firstSnapshot, snapshots.end(), [arg](const OptionSnapshot &snapshot) { return snapshot.option == arg; }))
+            snapshots.push_back({arg, arg->wasSet, arg->valueSource, arg->valueView, arg->values.size(), arg->integerValue, arg->byteSizeValue, arg->floatingPointValue, arg->booleanValue, arg->durationValue});
+        return arg;
+    }
+
+public:
+    explicit JournalCommandIndex(DArgumentParser &_parser) : parser(_parser) {}
+
+    void beginArgument() {
+        firstSnapshot = parser.optionSnapshots.size();
+    }
+
+    DArgumentOption *findLongCommand(std::string_view command) const {
+        return record(parser.findLongCommand(command));
+    }
+
+    DArgumentOption *findShortCommand(char command) const {
+        return record(parser.findShortCommand(command));
+    }
+};
+
+void DArgumentParser::rollBackArgument() {
+    const ArgumentJournalEntry &entry = argumentJournal.back();
+    for (size_t index = optionSnapshots.size(); index > entry.firstSnapshot; index--) {
+        const OptionSnapshot &snapshot = optionSnapshots[index - 1];
+        DArgumentOption *arg = snapshot.option;
+        arg->wasSet = snapshot.wasSet;
+        arg->valueSource = snapshot.valueSource;
+        arg->valueView = snapshot.valueView;
+        arg->value.clear();
+        arg->integerValue = snapshot.integerValue;
+        arg->byteSizeValue = snapshot.byteSizeValue;
+        arg->floatingPointValue = snapshot.floatingPointValue;
+        arg->booleanValue = snapshot.booleanValue;
+        arg->durationValue = snapshot.durationValue;
+        arg->values.resize(snapshot.valueCount);
+        arg->writeBinding();
+    }
+    optionSnapshots.resize(entry.firstSnapshot);
+    positionalArgsViews.resize(entry.positionalArgsCount);
+    occurrences.resize(entry.occurrenceCount);
+    //the arguments before a failed one all parsed, and the fallback sources aren't applied after it
+    if (entry.result != DParseResult::ParseSuccessful) {
+        errorText.clear();
+        ambiguousCandidates.clear();
+        suggestions.clear();
+    }
+    argumentJournal.pop_back();
+}
+
+void DArgumentParser::rollBackFallbackSources() {
+    //the fallback sources only set options the command line left unset, so unsetting them again restores the state they found
+    for (auto arg: editFallbackOptions)
+        if (arg->valueSource == DValueSource::Environment || arg->valueSource == DValueSource::ConfigFile)
+            arg->resetValue();
+    if (editParseResult != DParseResult::ParseSuccessful && (argumentJournal.empty() || argumentJournal.back().result == DParseResult::ParseSuccessful)) {
+        errorText.clear();
+        ambiguousCandidates.clear();
+        suggestions.clear();
+    }
+}
+
+DParseResult DArgumentParser::parseEditedArguments() {
+    ParseState state{argumentCount, argumentValues, false, updateSortedLongCommands(), arguments, responseFiles, positionalArgsViews, errorText, ambiguousCandidates};
+    state.statistics = &currentStatistics;
+    state.occurrences = &occurrences;
+    positionalArgsValues.clear();
+    if (!subcommands.empty()) {
+        //the arguments after the subcommand's name belong to another parser, so there's no journal to roll back
+        for (auto arg: argumentOptions)
+            arg->resetValue();
+        positionalArgsViews.clear();
+        errorText.clear();
+        ambiguousCandidates.clear();
+        occurrences.clear();
+        selectedSubcommand = nullptr;
+        state.stopAtFirstPositional = true;
+        DParseResult parseResult = parseCollectedArguments(*this, state);
+        return editParseResult = parseResult == DParseResult::ParseSuccessful ? completeParse(state) : suggestCommands(parseResult, state);
+    }
+    if (!argumentJournal.empty() && argumentJournal.back().result != DParseResult::ParseSuccessful)
+        rollBackArgument();
+    PhaseTimer timer(state.statistics, &DParseStatistics::lookupTime, &DParseStatistics::valueAssignmentTime);
+    JournalCommandIndex commandIndex(*this);
+    int argumentsSize = (int) arguments.size();
+    int index = argumentJournal.empty() ? 1 : argumentJournal.back().endArgument;
+    while (index < argumentsSize) {
+        ArgumentJournalEntry entry{index, index, optionSnapshots.size(), positionalArgsViews.size(), occurrences.size(), DParseResult::ParseSuccessful};
+        std::string_view argument = arguments[index];
+        commandIndex.beginArgument();
+        if (isLongCommand(argument))
+            entry.result = parseLongCommand(commandIndex, argument, entry.endArgument, state);
+        else if (isShortCommand(argument))
+            entry.result = parseShortCommand(commandIndex, argument, entry.endArgument, state);
+        else
+            positionalArgsViews.push_back(argument);
+        //a command missing its value ends past the last argument, appending the value parses it again
+        entry.endArgument = std::min(entry.endArgument + 1, argumentsSize);
+        argumentJournal.push_back(entry);
+        if (entry.result != DParseResult::ParseSuccessful)
+            return editParseResult = suggestCommands(entry.result, state);
+        index = entry.endArgument;
+    }
+    //like Parse, the fallback sources only fill in the options once the whole command line parsed, the next edit rolls them back first
+    DParseResult parseResult = parseFallbackSources(state, editEnvironment.data());
+    return editParseResult = parseResult == DParseResult::ParseSuccessful ? parseResult : suggestCommands(parseResult, state);
+}
+
+DParseResult DArgumentParser::editArguments(size_t keptCount, const std::string_view *appended, size_t appendedCount, bool isUndoable) {
+    if (!isEditingArguments)
+        BeginArgumentEditing();
+    beginStatistics();
+    rollBackFallbackSources();
+    keptCount = std::min(keptCount, editedArguments.size());
+    if (isUndoable)
+        argumentEdits.push_back({appendedCount, editedArguments.size() - keptCount});
+    int keptArguments = (int) keptCount + 1;
+    while (!argumentJournal.empty() && argumentJournal.back().endArgument > keptArguments)
+        rollBackArgument();
+    for (size_t index = keptCount; isUndoable && index < editedArguments.size(); index++)
+        removedArguments.push_back(std::move(editedArguments[index]));
+    editedArguments.erase(editedArguments.begin() + (long) keptCount, editedArguments.end());
+    arguments.resize(keptArguments);
+    for (size_t index = 0; index < appendedCount; index++)
+        arguments.push_back(editedArguments.emplace_back(appended[index]));
+    return finishStatistics(parseEditedArguments());
+}
+
+DArgumentParser &DArgumentParser::subcommandParser(SubcommandEntry &subcommand) {
+    if (subcommand.parser != nullptr)
+        return *subcommand.parser;
+    subcommand.argumentValues[0] = subcommand.executableName.data();
+    subcommand.parser = &subcommandParsers.emplace_back(1, subcommand.argumentValues, argumentOptions.get_allocator().resource(), std::string(appName), std::string(appVersion), std::string(subcommand.description));
+    subcommand.parser->allowAbbreviations = allowAbbreviations;
+    subcommand.factory(*subcommand.parser);
+    return *subcommand.parser;
+}
+
+DParseResult DArgumentParser::parseSubcommand(ParseState &state) {
+    if (state.positionalArgsViews.empty())
+        return DParseResult::ParseSuccessful;
+    std::string_view name = state.positionalArgsViews.front();
+    auto iterator = subcommandIndex.find(name);
+    if (iterator == subcommandIndex.end()) {
+        writeErrorText(state.errorText, DParseResult::InvalidSubcommand, name);
+        return DParseResult::InvalidSubcommand;
+    }
+    DArgumentParser &parser = subcommandParser(*iterator->second);
+    selectedSubcommand = iterator->second;
+    parser.resetParsedValues();
+    parser.environment = environment;
+    //the name of the subcommand takes the place of the executable name, response files were already expanded by this parser
+    auto inheritedArguments = state.arguments.begin() + state.firstUnparsedArgument - 1;
+    size_t inheritedSize = 0;
+    for (auto iterator = inheritedArguments; iterator != state.arguments.end(); ++iterator)
+        inheritedSize += iterator->size();
+    //the arguments may point into a response file, the command string or the edited arguments of this parser, which its next parse replaces
+    parser.inheritedArgumentText.clear();
+    parser.inheritedArgumentText.reserve(inheritedSize);
+    parser.arguments.clear();
+    for (auto iterator = inheritedArguments; iterator != state.arguments.end(); ++iterator) {
+        parser.arguments.emplace_back(parser.inheritedArgumentText.data() + parser.inheritedArgumentText.size(), iterator->size());
+        parser.inheritedArgumentText += *iterator;
+    }
+    ParseState subcommandState{parser.argumentCount, parser.argumentValues, false, parser.updateSortedLongCommands(), parser.arguments, parser.responseFiles, parser.positionalArgsViews, parser.errorText, parser.ambiguousCandidates};
+    subcommandState.stopAtFirstPositional = !parser.subcommands.empty();
+    subcommandState.statistics = state.statistics;
+    subcommandState.occurrences = &parser.occurrences;
+    DParseResult parseResult = parseCollectedArguments(parser, subcommandState);
+    parseResult = parseResult == DParseResult::ParseSuccessful ? parser.completeParse(subcommandState) : parser.suggestCommands(parseResult, subcommandState);
+    if (parseResult != DParseResult::ParseSuccessful) {
+        state.errorText.assign(parser.errorText);
+        suggestions.assign(parser.suggestions.begin(), parser.suggestions.end());
+    }
+    return parseResult;
+}
+
+DParseResult DArgumentParser::completeParse(ParseState &state) {
+    DParseResult parseResult = parseFallbackSources(state);
+    if (parseResult != DParseResult::ParseSuccessful)
+        return suggestCommands(parseResult, state);
+    if (!state.stopAtFirstPositional)
+        return parseResult;
+    return parseSubcommand(state);
+}
+
+void DArgumentParser::SetAppInfo(const std::string &name, const std::string &version, const std::string &description) {
+    appName.assign(name);
+    appVersion.assign(version);
+    appDescription.assign(description);
+    helpLayoutIsDirty = versionTextIsDirty = true;
+}
+
+void DArgumentParser::SetAppName(const std::string &name) {
+    appName.assign(name);
+    versionTextIsDirty = true;
+}
+
+void DArgumentParser::SetAppVersion(const std::string &version) {
+    appVersion.assign(version);
+    versionTextIsDirty = true;
+}
+
+void DArgumentParser::SetAppDescription(const std::string &description) {
+    appDescription.assign(description);
+    helpLayoutIsDirty = true;
+}
+
+void DArgumentParser::SetResponseFileExpansion(bool enabled) {
+    expandResponseFiles = enabled;
+}
+
+void DArgumentParser::SetLongCommandAbbreviation(bool enabled) {
+    allowAbbreviations = enabled;
+}
+
+void DArgumentParser::SetEnvironment(char **_environment) {
+    environment = _environment;
+}
+
+DParseResult DArgumentParser::LoadConfigFile(const std::string &path) {
+    //options may have been added or removed since the file was loaded, so the keys of an unchanged file are still checked
+    if (std::string_view(configFilePath) == path && configFile.IsUnchanged(path.c_str()))
+        return checkConfigKeys(configEntries, path);
+    //the new file is read into temporaries, so the one already loaded stays in use if it can't be loaded
+    DMappedFile file;
+    if (!file.Open(path)) {
+        writeErrorText(errorText, DParseResult::InvalidConfigFile, path);
+        return DParseResult::InvalidConfigFile;
+    }
+    std::pmr::vector<ConfigEntry> entries(configEntries.get_allocator());
+    size_t malformedLine = readConfigEntries(std::string_view(file.Data(), file.Size()), entries);
+    if (malformedLine != 0) {
+        errorText.clear();
+        errorText += "Config file ";
+        errorText += path;
+        errorText += ": line ";
+        errorText += std::to_string(malformedLine);
+        errorText += " is malformed";
+        return DParseResult::InvalidConfigFile;
+    }
+    DParseResult keysResult = checkConfigKeys(entries, path);
+    if (keysResult != DParseResult::ParseSuccessful)
+        return keysResult;
+    configFile = std::move(file);
+    configEntries = std::move(entries);
+    configFilePath.assign(path);
+    return DParseResult::ParseSuccessful;
+}
+
+DParseResult DArgumentParser::checkConfigKeys(const std::pmr::vector<ConfigEntry> &entries, std::string_view path) {
+    for (const auto &entry: entries) {
+        if (findLongCommand(entry.key) == nullptr) {
+            writeConfigErrorText(errorText, DParseResult::InvalidOption, entry.key, path);
+            return DParseResult::InvalidOption;
+        }
+    }
+    return DParseResult::ParseSuccessful;
+}
+
+void DArgumentParser::ClearConfigFile() {
+    configFile.Close();
+    configEntries.clear();
+    configFilePath.clear();
+}
+
+bool DArgumentParser::AddArgumentOption(DArgumentOption *dArgumentOption) {
+    if (!checkIfArgumentIsUnique(dArgumentOption))
+        return false;
+    if (!argumentOptions.insert(dArgumentOption).second)
+        return false;
+    addToCommandIndex(dArgumentOption);
+    helpLayoutIsDirty = sortedLongCommandsIsDirty = suggestionTableIsDirty = true;
+    return true;
+}
+
+bool DArgumentParser::AddArgumentOption(std::unordered_set<DArgumentOption *> &&args) {
+    argumentOptions.reserve(argumentOptions.size() + args.size());
+    //each option is checked against the ones added before it and indexed right away, so a single pass also finds the collisions inside the batch
+    for (auto iterator = args.begin(), end = args.end(); iterator != end; ++iterator) {
+        if (checkIfArgumentIsUnique(*iterator, &args)) {
+            argumentOptions.insert(*iterator);
+            addToCommandIndex(*iterator);
+            continue;
+        }
+        for (auto addedIterator = args.begin(); addedIterator != iterator; ++addedIterator)
+            argumentOptions.erase(*addedIterator);
+        pruneCommandIndex();
+        return false;
+    }
+    helpLayoutIsDirty = sortedLongCommandsIsDirty = suggestionTableIsDirty = true;
+    return true;
+}
+
+bool DArgumentParser::RemoveArgumentOption(DArgumentOption *argument) {
+    if (!argumentOptions.erase(argument))
+        return false;
+    pruneCommandIndex();
+    helpLayoutIsDirty = sortedLongCommandsIsDirty = suggestionTableIsDirty = true;
+    return true;
+}
+
+void DArgumentParser::ClearArgumentOptions() {
+    argumentOptions.clear();
+    shortCommandIndex.fill(nullptr);
+    longCommandIndex.clear();
+    environmentIndex.clear();
+    helpLayoutIsDirty = sortedLongCommandsIsDirty = suggestionTableIsDirty = true;
+}
+
+void DArgumentParser::AddPositionalArgument(std::string name, std::string description, std::string syntax) {
+    positionalArgs.emplace_back(std::move(name), std::move(description), std::move(syntax));
+    helpLayoutIsDirty = true;
+}
+
+void DArgumentParser::ClearPositionalArgumets() {
+    positionalArgs.clear();
+    helpLayoutIsDirty = true;
+}
+
+bool DArgumentParser::AddSubcommand(const std::string &name, const std::string &description, std::function<void(DArgumentParser &)> factory) {
+    registrationErrorText.clear();
+    if (name.empty() || name[0] == minusSign || name[0] == responseFileSign || std::any_of(name.begin(), name.end(), isWhitespace)) {
+        registrationErrorText += "Subcommand name \"";
+        registrationErrorText += name;
+        registrationErrorText += "\" is invalid";
+        return false;
+    }
+    if (subcommandIndex.find(name) != subcommandIndex.end()) {
+        registrationErrorText += "Subcommand ";
+        registrationErrorText += name;
+        registrationErrorText += " was already added";
+        return false;
+    }
+    SubcommandEntry &subcommand = subcommands.emplace_back(name, description, std::move(factory), executableName, subcommands.get_allocator().resource());
+    subcommandIndex.emplace(subcommand.name, &subcommand);
+    helpLayoutIsDirty = true;
+    return true;
+}
+
+std::string_view DArgumentParser::SelectedSubcommand() const {
+    return selectedSubcommand == nullptr ? std::string_view() : std::string_view(selectedSubcommand->name);
+}
+
+DArgumentParser *DArgumentParser::SubcommandParser() const {
+    return selectedSubcommand == nullptr ? nullptr : selectedSubcommand->parser;
+}
+
+int DArgumentParser::WasSet(char command) {
+    return Get(command).wasSet;
+}
+
+int DArgumentParser::WasSet(const std::string &command) {
+    return Get(command).wasSet;
+}
+
+const DArgumentOption &DArgumentParser::Get(char command) {
+    DArgumentOption *argument = shortCommandIndex[(unsigned char) command];
+    if (argument == nullptr)
+        return unsetOption;
+    resolveLazily(argument);
+    return *argument;
+}
+
+const DArgumentOption &DArgumentParser::Get(const std::string &command) {
+    auto iterator = longCommandIndex.find(command);
+    if (iterator == longCommandIndex.end())
+        return unsetOption;
+    resolveLazily(iterator->second);
+    return *iterator->second;
+}
+
+const DArgumentOption &DArgumentParser::Get(const DArgumentOption &option) {
+    auto iterator = argumentOptions.find(const_cast<DArgumentOption *>(&option));
+    if (iterator == argumentOptions.end())
+        return unsetOption;
+    resolveLazily(*iterator);
+    return option;
 }
 
 const std::vector<std::string> &DArgumentParser::GetPositionalArguments() const {
+    if (positionalArgsValues.size() != positionalArgsViews.size())
+        positionalArgsValues.assign(positionalArgsViews.begin(), positionalArgsViews.end());
     return positionalArgsValues;
 }
 
-std::string DArgumentParser::VersionText() {
-    std::string versionText;
+const std::pmr::vector<std::string_view> &DArgumentParser::GetPositionalArgumentViews() const {
+    return positionalArgsViews;
+}
+
+const std::pmr::vector<std::string_view> &DArgumentParser::GetAmbiguousCandidates() const {
+    return ambiguousCandidates;
+}
+
+const std::pmr::vector<DArgumentOccurrence> &DArgumentParser::GetOccurrences() const {
+    return occurrences;
+}
+
+const std::pmr::vector<std::string_view> &DArgumentParser::GetSuggestions() const {
+    return suggestions;
+}
+
+const std::string &DArgumentParser::VersionText() {
+    if (!versionTextIsDirty)
+        return versionText;
+    versionTextIsDirty = false;
+    versionText.clear();
     versionText.reserve(appName.size() + appVersion.size() + 2);
     versionText.append(appName);
     versionText += ' ';
@@ -501,44 +2103,896 @@ std::string DArgumentParser::VersionText() {
     return versionText;
 }
 
-std::string DArgumentParser::HelpText() {
-    std::string helpText;
-    std::string usageSection = generateUsageSection();
-    std::string descriptionSection = generateDescriptionSection();
-    std::string posArgsSection = generatePositionalArgsSection();
-    std::string optionsSection = generateOptionsSection();
-    helpText.reserve(usageSection.size() + descriptionSection.size() + posArgsSection.size() + optionsSection.size());
-    helpText += usageSection;
-    helpText += descriptionSection;
-    helpText += posArgsSection;
-    helpText += optionsSection;
+const std::string &DArgumentParser::HelpText() {
+    updateHelpLayout();
+    if (!helpTextIsDirty)
+        return helpText;
+    helpTextIsDirty = false;
+    helpText.clear();
+    DStringHelpSink sink(helpText);
+    WriteHelp(sink);
     return helpText;
 }
 
+void DArgumentParser::WriteHelp(DHelpSink &sink) {
+    beginStatistics();
+    {
+        PhaseTimer timer(&currentStatistics, &DParseStatistics::helpGenerationTime);
+        updateHelpLayout();
+        writeUsageSection(sink);
+        writeDescriptionSection(sink);
+        writePositionalArgsSection(sink);
+        writeSubcommandsSection(sink);
+        writeOptionsSubSection(sink, helpAndVersionOptionsLayout, helpAndVersionOptionsColumnSize, helpAndVersionOptionsSectionOpeningString);
+        writeOptionsSubSection(sink, normalOptionsLayout, normalOptionsColumnSize, normalOptionSectionOpeningString);
+        sink.Flush();
+    }
+    finishStatistics(DParseResult::ParseSuccessful, false);
+}
+
+void DArgumentParser::WriteCompletionScript(DHelpSink &sink, DCompletionShell shell) {
+    std::string functionName = "_";
+    functionName += executableName;
+    functionName += "_complete";
+    std::replace_if(functionName.begin(), functionName.end(), [](char c) { return !std::isalnum((unsigned char) c); }, '_');
+    switch (shell) {
+        case DCompletionShell::Bash:
+            sink.Write(functionName);
+            sink.Write("() {\n"
+                       "    local IFS=$'\\n'\n"
+                       "    COMPREPLY=($(\"${COMP_WORDS[0]}\" __complete \"${COMP_WORDS[@]:1:COMP_CWORD}\" 2>/dev/null))\n"
+                       "    COMPREPLY=(\"${COMPREPLY[@]%%$'\\t'*}\")\n"
+                       "}\n"
+                       "complete -o default -F ");
+            sink.Write(functionName);
+            sink.Write(" ");
+            sink.Write(executableName);
+            sink.Write("\n");
+            break;
+        case DCompletionShell::Zsh:
+            sink.Write("#compdef ");
+            sink.Write(executableName);
+            sink.Write("\n");
+            sink.Write(functionName);
+            sink.Write("() {\n"
+                       "    local -a candidates\n"
+                       "    candidates=(\"${(@f)$(\"${words[1]}\" __complete \"${(@)words[2,CURRENT]}\" 2>/dev/null)}\")\n"
+                       "    candidates=(\"${(@)candidates//:/\\:}\")\n"
+                       "    candidates=(\"${(@)candidates//$'\\t'/:}\")\n"
+                       "    if [[ -n \"${candidates[1]}\" ]]; then\n"
+                       "        _describe 'values' candidates\n"
+                       "    else\n"
+                       "        _files\n"
+                       "    fi\n"
+                       "}\n"
+                       "compdef ");
+            sink.Write(functionName);
+            sink.Write(" ");
+            sink.Write(executableName);
+            sink.Write("\n");
+            break;
+        case DCompletionShell::Fish:
+            sink.Write("complete -c ");
+            sink.Write(executableName);
+            sink.Write(" -a '(");
+            sink.Write(executableName);
+            sink.Write(" __complete (commandline -opc)[2..-1] (commandline -ct) 2>/dev/null)'\n");
+            break;
+    }
+    sink.Flush();
+}
+
+bool DArgumentParser::WriteCompletions(DHelpSink &sink) {
+    if (argumentCount < 2 || completionQuery != argumentValues[1])
+        return false;
+    writeCompletions(sink, argumentValues + 2, argumentCount - 2);
+    sink.Flush();
+    return true;
+}
+
+void DArgumentParser::writeCompletion(DHelpSink &sink, std::string_view prefix, std::string_view candidate, std::string_view description) {
+    sink.Write(prefix);
+    sink.Write(candidate);
+    if (!description.empty()) {
+        sink.Write("\t");
+        sink.Write(description);
+    }
+    sink.Write("\n");
+}
+
+void DArgumentParser::writeValueCompletions(DHelpSink &sink, const DArgumentOption *arg, std::string_view prefix, std::string_view value) {
+    if (arg->valueType != DArgumentValueType::Boolean)
+        return;
+    for (std::string_view candidate: {"true", "false"})
+        if (candidate.substr(0, value.size()) == value)
+            writeCompletion(sink, prefix, candidate, {});
+}
+
+void DArgumentParser::writeCompletions(DHelpSink &sink, char **words, int wordCount) {
+    std::string_view word = wordCount > 0 ? words[wordCount - 1] : "";
+    bool positionalWasPassed = false;
+    for (int index = 0; index + 1 < wordCount; index++) {
+        std::string_view previous = words[index];
+        const DArgumentOption *arg = nullptr;
+        if (isLongCommand(previous)) {
+            if (previous.find(equalSign) == std::string_view::npos)
+                arg = findLongCommand(previous.substr(longCommandStartPos));
+        } else if (isShortCommand(previous))
+            arg = findShortCommand(previous.back());
+        else if (!positionalWasPassed && !subcommands.empty()) {
+            auto iterator = subcommandIndex.find(previous);
+            if (iterator != subcommandIndex.end()) {
+                subcommandParser(*iterator->second).writeCompletions(sink, words + index + 1, wordCount - index - 1);
+                return;
+            }
+            positionalWasPassed = true;
+        } else
+            positionalWasPassed = true;
+        if (arg == nullptr || arg->type != DArgumentOptionType::InputOption)
+            continue;
+        //the word after an option that takes a value is that value
+        if (index + 2 == wordCount) {
+            writeValueCompletions(sink, arg, {}, word);
+            return;
+        }
+        index++;
+    }
+    if (isLongCommand(word) && word.find(equalSign) != std::string_view::npos) {
+        size_t posOfEqualSign = word.find(equalSign);
+        const DArgumentOption *arg = findLongCommand(word.substr(longCommandStartPos, posOfEqualSign - longCommandStartPos));
+        if (arg != nullptr && arg->type == DArgumentOptionType::InputOption)
+            writeValueCompletions(sink, arg, word.substr(0, posOfEqualSign + 1), word.substr(posOfEqualSign + 1));
+        return;
+    }
+    if (word.size() >= 2 && word[0] == minusSign && word[1] != minusSign) {
+        //a cluster of short commands is complete as is, as long as every command in it exists
+        if (std::all_of(word.begin() + shortCommandStartPos, word.end(), [this](char command) { return findShortCommand(command) != nullptr; }))
+            writeCompletion(sink, {}, word, {});
+        return;
+    }
+    if (word.size() == 1 && word[0] == minusSign) {
+        for (int command = 0; command < (int) shortCommandIndex.size(); command++) {
+            const DArgumentOption *arg = shortCommandIndex[command];
+            const char shortCommand = (char) command;
+            if (arg != nullptr)
+                writeCompletion(sink, "-", std::string_view(&shortCommand, 1), arg->description);
+        }
+    }
+    if (!word.empty() && word[0] == minusSign) {
+        std::string_view prefix = word.size() > 1 ? word.substr(longCommandStartPos) : std::string_view();
+        const auto &commands = sortedLongCommandTable();
+        for (auto iterator = std::lower_bound(commands.begin(), commands.end(), prefix); iterator != commands.end() && iterator->substr(0, prefix.size()) == prefix; ++iterator)
+            writeCompletion(sink, "--", *iterator, findLongCommand(*iterator)->description);
+        return;
+    }
+    if (positionalWasPassed)
+        return;
+    for (const auto &subcommand: subcommands)
+        if (std::string_view(subcommand.name).substr(0, word.size()) == word)
+            writeCompletion(sink, {}, subcommand.name, subcommand.description);
+}
+
 std::string DArgumentParser::ErrorText() const {
-    return errorText;
+    return std::string(errorText);
+}
+
+void DArgumentParser::SetStatisticsObserver(std::function<void(const DParseStatistics &)> observer) {
+    statisticsObserver = std::move(observer);
+}
+
+const DParseStatistics &DArgumentParser::GetStatistics() const {
+    return totalStatistics;
+}
+
+void DArgumentParser::ResetStatistics() {
+    totalStatistics = DParseStatistics();
+}
+
+std::string DArgumentParser::RegistrationErrorText() const {
+    return std::string(registrationErrorText);
+}
+
+DParseResult DArgumentParser::ParseCommandString(std::string_view _commandString) {
+    beginStatistics();
+    resetParsedValues();
+    ParseState state{argumentCount, argumentValues, expandResponseFiles, updateSortedLongCommands(), arguments, responseFiles, positionalArgsViews, errorText, ambiguousCandidates};
+    state.statistics = &currentStatistics;
+    state.occurrences = &occurrences;
+    DParseResult parseResult = DParseResult::ParseSuccessful;
+    {
+        PhaseTimer timer(state.statistics, &DParseStatistics::tokenizeTime);
+        commandString.assign(_commandString);
+        commandStringArguments.clear();
+        DCommandTokenizer::TokenizeInPlace(commandString.data(), commandString.data() + commandString.size(), commandStringArguments);
+        arguments.reserve(commandStringArguments.size() + 1);
+        arguments.emplace_back(argumentCount > 0 ? argumentValues[0] : "");
+        for (auto argument: commandStringArguments)
+            if ((parseResult = collectArgument(argument, state)) != DParseResult::ParseSuccessful)
+                break;
+    }
+    if (parseResult != DParseResult::ParseSuccessful)
+        return finishStatistics(parseResult);
+    state.stopAtFirstPositional = !subcommands.empty();
+    parseResult = parseCollectedArguments(*this, state);
+    return finishStatistics(parseResult == DParseResult::ParseSuccessful ? completeParse(state) : suggestCommands(parseResult, state));
+}
+
+DParseResult DArgumentParser::ParseLazily() {
+    if (!subcommands.empty())
+        return lazyParseResult = Parse();
+    beginStatistics();
+    resetParseState();
+    lazyCommandTokens.clear();
+    lazyResolvedOptions.clear();
+    lazyEnvironment.clear();
+    ParseState state{argumentCount, argumentValues, expandResponseFiles, nullptr, arguments, responseFiles, positionalArgsViews, errorText, ambiguousCandidates};
+    state.statistics = &currentStatistics;
+    {
+        PhaseTimer timer(state.statistics, &DParseStatistics::tokenizeTime);
+        lazyParseResult = collectArguments(state);
+        //values and positional arguments can only be told apart once the options are known, so only the commands are recorded here
+        for (int index = 1; lazyParseResult == DParseResult::ParseSuccessful && index < (int) arguments.size(); index++)
+            if (isLongCommand(arguments[index]) || isShortCommand(arguments[index]))
+                lazyCommandTokens.push_back(index);
+    }
+    if (lazyParseResult != DParseResult::ParseSuccessful) {
+        for (auto arg: argumentOptions)
+            arg->resetValue();
+        return finishStatistics(lazyParseResult);
+    }
+    lazyParsePending = true;
+    return finishStatistics(DParseResult::ParseSuccessful);
+}
+
+DParseResult DArgumentParser::Validate() {
+    if (!lazyParsePending)
+        return lazyParseResult;
+    lazyParsePending = false;
+    positionalArgsViews.clear();
+    errorText.clear();
+    ambiguousCandidates.clear();
+    occurrences.clear();
+    for (auto arg: argumentOptions)
+        arg->resetValue();
+    beginStatistics();
+    ParseState state{argumentCount, argumentValues, expandResponseFiles, updateSortedLongCommands(), arguments, responseFiles, positionalArgsViews, errorText, ambiguousCandidates};
+    state.statistics = &currentStatistics;
+    state.occurrences = &occurrences;
+    lazyParseResult = parseCollectedArguments(*this, state);
+    lazyParseResult = lazyParseResult == DParseResult::ParseSuccessful ? completeParse(state) : suggestCommands(lazyParseResult, state);
+    return finishStatistics(lazyParseResult);
+}
+
+DParseResult DArgumentParser::BeginArgumentEditing() {
+    beginStatistics();
+    resetParsedValues();
+    editedArguments.clear();
+    argumentJournal.clear();
+    optionSnapshots.clear();
+    argumentEdits.clear();
+    removedArguments.clear();
+    editEnvironment.clear();
+    editFallbackOptions.clear();
+    isEditingArguments = true;
+    arguments.emplace_back(argumentCount > 0 ? argumentValues[0] : "");
+    for (int index = 1; index < argumentCount; index++)
+        arguments.push_back(editedArguments.emplace_back(argumentValues[index]));
+    //parsers with subcommands are parsed in full on every edit, the others apply the fallback sources from these after each edit
+    if (subcommands.empty()) {
+        filterEnvironment(editEnvironment);
+        for (auto variable = editEnvironment.begin(); *variable != nullptr; ++variable) {
+            std::string_view entry(*variable);
+            editFallbackOptions.push_back(environmentIndex.find(entry.substr(0, entry.find(equalSign)))->second);
+        }
+        for (const auto &entry: configEntries)
+            if (DArgumentOption *arg = findLongCommand(entry.key))
+                editFallbackOptions.push_back(arg);
+    }
+    return finishStatistics(parseEditedArguments());
+}
+
+DParseResult DArgumentParser::AppendArgument(std::string_view argument) {
+    return editArguments(editedArguments.size(), &argument, 1, true);
+}
+
+DParseResult DArgumentParser::ReplaceLastArgument(std::string_view argument) {
+    return editArguments(editedArguments.empty() ? 0 : editedArguments.size() - 1, &argument, 1, true);
+}
+
+DParseResult DArgumentParser::TruncateArguments(size_t count) {
+    return editArguments(count, nullptr, 0, true);
+}
+
+DParseResult DArgumentParser::UndoArgumentEdit() {
+    if (!isEditingArguments || argumentEdits.empty())
+        return editParseResult;
+    ArgumentEdit edit = argumentEdits.back();
+    argumentEdits.pop_back();
+    std::pmr::vector<std::string_view> restored(removedArguments.end() - (long) edit.removedCount, removedArguments.end(), removedArguments.get_allocator());
+    DParseResult parseResult = editArguments(editedArguments.size() - edit.appendedCount, restored.data(), restored.size(), false);
+    removedArguments.resize(removedArguments.size() - edit.removedCount);
+    return parseResult;
+}
+
+size_t DArgumentParser::EditedArgumentCount() const {
+    return isEditingArguments ? editedArguments.size() : 0;
+}
+
+DArgumentSchema DArgumentParser::CreateSchema() const {
+    return DArgumentSchema(std::vector<const DArgumentOption *>(argumentOptions.begin(), argumentOptions.end()), expandResponseFiles, allowAbbreviations);
+}
+
+std::string DArgumentParser::CreateSchemaImage() {
+    std::vector<DArgumentOption *> options(argumentOptions.begin(), argumentOptions.end());
+    std::unordered_map<const DArgumentOption *, unsigned> optionIndexes;
+    std::string strings;
+    auto addString = [&strings](std::vector<unsigned> &words, std::string_view text) {
+        words.push_back((unsigned) strings.size());
+        words.push_back((unsigned) text.size());
+        strings += text;
+    };
+    std::vector<unsigned> words(ImageHeaderSize);
+    words[ImageOptionsOffset] = (unsigned) (words.size() * sizeof(unsigned));
+    for (auto arg: options) {
+        optionIndexes.emplace(arg, (unsigned) optionIndexes.size());
+        words.push_back((unsigned) arg->type | (unsigned) arg->valueType << 8 | (unsigned) arg->multipleValues << 16);
+        addString(words, arg->description);
+    }
+    words[ImageShortIndexOffset] = (unsigned) (words.size() * sizeof(unsigned));
+    for (auto arg: shortCommandIndex)
+        words.push_back(arg == nullptr ? (unsigned) -1 : optionIndexes[arg]);
+    words[ImageLongIndexOffset] = (unsigned) (words.size() * sizeof(unsigned));
+    for (auto command: sortedLongCommandTable()) {
+        addString(words, command);
+        words.push_back(optionIndexes[findLongCommand(command)]);
+    }
+    std::vector<std::pair<std::string_view, const DArgumentOption *>> environmentVariables(environmentIndex.begin(), environmentIndex.end());
+    std::sort(environmentVariables.begin(), environmentVariables.end());
+    words[ImageEnvironmentIndexOffset] = (unsigned) (words.size() * sizeof(unsigned));
+    for (const auto &entry: environmentVariables) {
+        addString(words, entry.first);
+        words.push_back(optionIndexes[entry.second]);
+    }
+    std::vector<unsigned> texts;
+    addString(texts, HelpText());
+    addString(texts, VersionText());
+    std::copy(texts.begin(), texts.end(), words.begin() + ImageHelpText);
+    words[ImageMagic] = schemaImageMagic;
+    words[ImageVersion] = schemaImageVersion;
+    words[ImageFlags] = (expandResponseFiles ? schemaImageResponseFilesFlag : 0) | (allowAbbreviations ? schemaImageAbbreviationsFlag : 0);
+    words[ImageOptionCount] = (unsigned) options.size();
+    words[ImageLongCommandCount] = (unsigned) longCommandIndex.size();
+    words[ImageEnvironmentCount] = (unsigned) environmentVariables.size();
+    words[ImageStringsOffset] = (unsigned) (words.size() * sizeof(unsigned));
+    words[ImageStringsSize] = (unsigned) strings.size();
+    words[ImageSize] = words[ImageStringsOffset] + words[ImageStringsSize];
+    std::string image(reinterpret_cast<const char *>(words.data()), words.size() * sizeof(unsigned));
+    image += strings;
+    return image;
 }
 
 DParseResult DArgumentParser::Parse() {
+    beginStatistics();
     resetParsedValues();
-    if (argumentCount < 2)
-        return DParseResult::ParseSuccessful;
-    DParseResult parseResult;
-    for (int index = 1; index < argumentCount; index++) {
-        std::string currArg(argumentValues[index]);
-        if (isLongCommand(currArg)) {
-            parseResult = parseLongCommand(currArg, index);
-            if (parseResult != DParseResult::ParseSuccessful)
-                return parseResult;
+    ParseState state{argumentCount, argumentValues, expandResponseFiles, updateSortedLongCommands(), arguments, responseFiles, positionalArgsViews, errorText, ambiguousCandidates};
+    state.stopAtFirstPositional = !subcommands.empty();
+    state.statistics = &currentStatistics;
+    state.occurrences = &occurrences;
+    DParseResult parseResult = parseArguments(*this, state);
+    return finishStatistics(parseResult == DParseResult::ParseSuccessful ? completeParse(state) : suggestCommands(parseResult, state));
+}
+
+/* ------ schema ------ */
+/**
+ * Resolves the commands through the schema, returning the options of the outcome that receive the results.
+ */
+class DArgumentSchema::OutcomeCommandIndex {
+    const DArgumentSchema &schema;
+    std::vector<DArgumentOption> &options;
+
+public:
+    OutcomeCommandIndex(const DArgumentSchema &_schema, std::vector<DArgumentOption> &_options) : schema(_schema), options(_options) {}
+
+    DArgumentOption *findLongCommand(std::string_view command) const {
+        int index = schema.findOption(command);
+        return index < 0 ? nullptr : &options[index];
+    }
+
+    DArgumentOption *findShortCommand(char command) const {
+        int index = schema.findOption(command);
+        return index < 0 ? nullptr : &options[index];
+    }
+};
+
+DArgumentSchema::DArgumentSchema(const std::vector<const DArgumentOption *> &_options, bool _expandResponseFiles, bool _allowAbbreviations) : expandResponseFiles(_expandResponseFiles), allowAbbreviations(_allowAbbreviations) {
+    shortCommandIndex.fill(-1);
+    //reserved up front, the index holds views into the long commands of these copies
+    options.reserve(_options.size());
+    for (auto option: _options) {
+        bool isUnique = option != nullptr && (!option->ShortCommands().empty() || !option->LongCommands().empty()) && sourceIndex.find(option) == sourceIndex.end();
+        if (isUnique)
+            for (auto shortCommand: option->ShortCommands())
+                isUnique = isUnique && shortCommandIndex[(unsigned char) shortCommand] < 0;
+        if (isUnique)
+            for (const auto &longCommand: option->LongCommands())
+                isUnique = isUnique && longCommandIndex.find(longCommand) == longCommandIndex.end();
+        isUnique = isUnique && environmentIndex.find(option->EnvironmentVariable()) == environmentIndex.end();
+        if (!isUnique) {
+            valid = false;
             continue;
         }
-        if (isShortCommand(currArg)) {
-            parseResult = parseShortCommand(currArg, index);
-            if (parseResult != DParseResult::ParseSuccessful)
-                return parseResult;
-            continue;
+        int index = (int) options.size();
+        const DArgumentOption &copy = options.emplace_back(*option);
+        sourceIndex.emplace(option, index);
+        for (auto shortCommand: copy.ShortCommands())
+            shortCommandIndex[(unsigned char) shortCommand] = index;
+        for (const auto &longCommand: copy.LongCommands())
+            longCommandIndex.emplace(longCommand, index);
+        if (!copy.EnvironmentVariable().empty())
+            environmentIndex.emplace(copy.EnvironmentVariable(), index);
+    }
+    if (!allowAbbreviations)
+        return;
+    sortedLongCommands.reserve(longCommandIndex.size());
+    for (const auto &entry: longCommandIndex)
+        sortedLongCommands.push_back(entry.first);
+    std::sort(sortedLongCommands.begin(), sortedLongCommands.end());
+}
+
+int DArgumentSchema::findOption(char command) const {
+    return shortCommandIndex[(unsigned char) command];
+}
+
+int DArgumentSchema::findOption(std::string_view command) const {
+    auto iterator = longCommandIndex.find(command);
+    return iterator == longCommandIndex.end() ? -1 : iterator->second;
+}
+
+bool DArgumentSchema::IsValid() const {
+    return valid;
+}
+
+size_t DArgumentSchema::OptionCount() const {
+    return options.size();
+}
+
+int DArgumentSchema::IndexOf(const DArgumentOption &option) const {
+    auto iterator = sourceIndex.find(&option);
+    return iterator == sourceIndex.end() ? -1 : iterator->second;
+}
+
+DParseOutcome DArgumentSchema::Parse(int argc, char **argv) const {
+    DParseOutcome outcome(this);
+    outcome.options.reserve(options.size());
+    for (const auto &option: options) {
+        DArgumentOption &outcomeOption = outcome.options.emplace_back(option.GetType(), std::string());
+        outcomeOption.SetValueType(option.GetValueType());
+        outcomeOption.SetMultipleValues(option.HasMultipleValues());
+    }
+    DArgumentParser::ParseState state{argc, argv, expandResponseFiles, allowAbbreviations ? &sortedLongCommands : nullptr, outcome.arguments, outcome.responseFiles, outcome.positionalArgsViews, outcome.errorText, outcome.ambiguousCandidates};
+    outcome.result = DArgumentParser::parseArguments(OutcomeCommandIndex(*this, outcome.options), state);
+    if (outcome.result == DParseResult::ParseSuccessful && !environmentIndex.empty())
+        outcome.result = DArgumentParser::parseEnvironment(environ, [this, &outcome](std::string_view name) {
+            auto iterator = environmentIndex.find(name);
+            return iterator == environmentIndex.end() ? nullptr : &outcome.options[iterator->second];
+        }, state);
+    return outcome;
+}
+
+/**
+ * Used by each thread of a batch for all the command lines it parses, it remembers which options were found in the current line so only those need to be collected and reset afterwards.
+ */
+class DArgumentSchema::BatchCommandIndex {
+    const DArgumentSchema &schema;
+    mutable std::vector<DArgumentOption> options;
+    mutable std::vector<int> foundOptions;
+    std::pmr::vector<DMappedFile> responseFiles;
+    std::pmr::vector<std::string_view> positionalArgsViews;
+    std::pmr::string errorText;
+    std::pmr::vector<std::string_view> ambiguousCandidates;
+
+    DArgumentOption *found(int index) const {
+        if (index < 0)
+            return nullptr;
+        if (options[index].wasSet == 0)
+            foundOptions.push_back(index);
+        return &options[index];
+    }
+
+public:
+    std::pmr::vector<std::string_view> arguments;
+
+    explicit BatchCommandIndex(const DArgumentSchema &_schema) : schema(_schema) {
+        options.reserve(schema.options.size());
+        for (const auto &option: schema.options)
+            options.emplace_back(option.type, std::string()).valueType = option.valueType;
+    }
+
+    DArgumentOption *findLongCommand(std::string_view command) const {
+        return found(schema.findOption(command));
+    }
+
+    DArgumentOption *findShortCommand(char command) const {
+        return found(schema.findOption(command));
+    }
+
+    DParseResult parse() {
+        DArgumentParser::ParseState state{0, nullptr, false, schema.allowAbbreviations ? &schema.sortedLongCommands : nullptr, arguments, responseFiles, positionalArgsViews, errorText, ambiguousCandidates};
+        return DArgumentParser::parseCollectedArguments(*this, state);
+    }
+
+    /**
+     * Writes the options set in the line parsed last into the bitmap and values, getting ready for the next line.
+     */
+    void collect(unsigned long long *setOptions, std::vector<DBatchValue> &values) {
+        for (int index: foundOptions) {
+            DArgumentOption &option = options[index];
+            if (option.wasSet > 0) {
+                setOptions[index / 64] |= 1ULL << (index % 64);
+                if (!option.valueView.empty())
+                    values.push_back({index, option.valueView});
+            }
+            option.resetValue();
         }
-        positionalArgsValues.push_back(currArg);
+        foundOptions.clear();
+        arguments.clear();
+        positionalArgsViews.clear();
+        ambiguousCandidates.clear();
     }
-    return DParseResult::ParseSuccessful;
+};
+
+template<typename LineArguments>
+DBatchParseResults DArgumentSchema::parseBatch(size_t lineCount, const LineArguments &lineArguments, unsigned threadCount) const {
+    DBatchParseResults batch;
+    batch.bitmapWords = (options.size() + 63) / 64;
+    batch.chunkSize = batchChunkSize;
+    batch.results.resize(lineCount);
+    batch.setOptions.resize(lineCount * batch.bitmapWords);
+    batch.valuesBegin.resize(lineCount);
+    size_t chunkCount = (lineCount + batchChunkSize - 1) / batchChunkSize;
+    batch.chunkValues.resize(chunkCount);
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = (unsigned) std::min<size_t>(threadCount, chunkCount);
+    //chunks are taken from a shared counter, so a thread that finishes early keeps taking the work left instead of waiting for the others
+    std::atomic<size_t> nextChunk{0};
+    auto parseChunks = [&]() {
+        BatchCommandIndex commandIndex(*this);
+        for (size_t chunk = nextChunk.fetch_add(1, std::memory_order_relaxed); chunk < chunkCount; chunk = nextChunk.fetch_add(1, std::memory_order_relaxed)) {
+            std::vector<DBatchValue> &values = batch.chunkValues[chunk];
+            for (size_t line = chunk * batchChunkSize, end = std::min(lineCount, line + batchChunkSize); line < end; line++) {
+                lineArguments(line, commandIndex.arguments);
+                batch.results[line] = commandIndex.parse();
+                batch.valuesBegin[line] = (unsigned) values.size();
+                commandIndex.collect(batch.setOptions.data() + line * batch.bitmapWords, values);
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned thread = 1; thread < threadCount; thread++)
+        threads.emplace_back(parseChunks);
+    parseChunks();
+    for (auto &thread: threads)
+        thread.join();
+    return batch;
+}
+
+DBatchParseResults DArgumentSchema::ParseBatch(const std::vector<std::vector<std::string_view>> &commandLines, unsigned threadCount) const {
+    return parseBatch(commandLines.size(), [&commandLines](size_t line, std::pmr::vector<std::string_view> &arguments) {
+        arguments.assign(commandLines[line].begin(), commandLines[line].end());
+    }, threadCount);
+}
+
+DBatchParseResults DArgumentSchema::ParseBatch(std::string_view buffer, char lineDelimiter, unsigned threadCount) const {
+    std::vector<std::string_view> lines;
+    for (size_t lineStart = 0; lineStart < buffer.size();) {
+        size_t lineEnd = std::min(buffer.find(lineDelimiter, lineStart), buffer.size());
+        lines.push_back(buffer.substr(lineStart, lineEnd - lineStart));
+        lineStart = lineEnd + 1;
+    }
+    return parseBatch(lines.size(), [&lines](size_t line, std::pmr::vector<std::string_view> &arguments) {
+        splitArgumentsOnWhitespaces(lines[line], arguments);
+    }, threadCount);
+}
+
+/* ------ batch parse results ------ */
+size_t DBatchParseResults::Size() const {
+    return results.size();
+}
+
+DParseResult DBatchParseResults::Result(size_t line) const {
+    return results[line];
+}
+
+bool DBatchParseResults::WasSet(size_t line, int option) const {
+    return (SetOptions(line)[option / 64] >> (option % 64)) & 1;
+}
+
+const unsigned long long *DBatchParseResults::SetOptions(size_t line) const {
+    return setOptions.data() + line * bitmapWords;
+}
+
+size_t DBatchParseResults::BitmapWords() const {
+    return bitmapWords;
+}
+
+size_t DBatchParseResults::ValueCount(size_t line) const {
+    size_t chunk = line / chunkSize;
+    size_t end = (line + 1) % chunkSize == 0 || line + 1 == results.size() ? chunkValues[chunk].size() : valuesBegin[line + 1];
+    return end - valuesBegin[line];
+}
+
+const DBatchValue &DBatchParseResults::Value(size_t line, size_t index) const {
+    return chunkValues[line / chunkSize][valuesBegin[line] + index];
+}
+
+std::string_view DBatchParseResults::GetValue(size_t line, int option) const {
+    for (size_t index = 0, count = ValueCount(line); index < count; index++)
+        if (Value(line, index).option == option)
+            return Value(line, index).value;
+    return {};
+}
+
+/* ------ parse outcome ------ */
+DParseOutcome::DParseOutcome(const DArgumentSchema *_schema) : schema(_schema) {}
+
+DParseResult DParseOutcome::Result() const {
+    return result;
+}
+
+const DArgumentOption &DParseOutcome::Get(const DArgumentOption &option) const {
+    int index = schema->IndexOf(option);
+    return index < 0 ? unsetOption : options[index];
+}
+
+const DArgumentOption &DParseOutcome::Get(char command) const {
+    int index = schema->findOption(command);
+    return index < 0 ? unsetOption : options[index];
+}
+
+const DArgumentOption &DParseOutcome::Get(std::string_view command) const {
+    int index = schema->findOption(command);
+    return index < 0 ? unsetOption : options[index];
+}
+
+int DParseOutcome::WasSet(const DArgumentOption &option) const {
+    return Get(option).WasSet();
+}
+
+int DParseOutcome::WasSet(char command) const {
+    return Get(command).WasSet();
+}
+
+int DParseOutcome::WasSet(std::string_view command) const {
+    return Get(command).WasSet();
+}
+
+const std::vector<std::string> &DParseOutcome::GetPositionalArguments() const {
+    if (positionalArgsValues.size() != positionalArgsViews.size())
+        positionalArgsValues.assign(positionalArgsViews.begin(), positionalArgsViews.end());
+    return positionalArgsValues;
+}
+
+const std::pmr::vector<std::string_view> &DParseOutcome::GetPositionalArgumentViews() const {
+    return positionalArgsViews;
+}
+
+const std::pmr::vector<std::string_view> &DParseOutcome::GetAmbiguousCandidates() const {
+    return ambiguousCandidates;
+}
+
+std::string DParseOutcome::ErrorText() const {
+    return std::string(errorText);
+}
+
+/* ------ mapped argument parser ------ */
+/**
+ * Resolves the commands through the tables of the image, giving each option found a DArgumentOption the first time it's found in a parse.
+ */
+class DMappedArgumentParser::ImageCommandIndex {
+    DMappedArgumentParser &parser;
+
+public:
+    explicit ImageCommandIndex(DMappedArgumentParser &_parser) : parser(_parser) {}
+
+    DArgumentOption *found(int index) const {
+        if (index < 0)
+            return nullptr;
+        int &slot = parser.optionSlots[index];
+        if (slot >= 0)
+            return &parser.foundOptions[slot];
+        unsigned record = parser.word(ImageOptionsOffset * sizeof(unsigned)) + index * schemaImageEntrySize;
+        unsigned types = parser.word(record);
+        //reserved for every option on load, so the options already found never move
+        slot = (int) parser.foundOptions.size();
+        parser.foundOptionIndexes.push_back(index);
+        DArgumentOption &option = parser.foundOptions.emplace_back((DArgumentOptionType) (types & 0xFF), std::string());
+        option.SetValueType((DArgumentValueType) (types >> 8 & 0xFF));
+        option.SetMultipleValues(types >> 16);
+        return &option;
+    }
+
+    DArgumentOption *findLongCommand(std::string_view command) const {
+        return found(parser.findOption(command));
+    }
+
+    DArgumentOption *findShortCommand(char command) const {
+        return found(parser.findOption(command));
+    }
+};
+
+DMappedArgumentParser::DMappedArgumentParser(int argc, char **argv) : argumentCount(argc), argumentValues(argv) {}
+
+unsigned DMappedArgumentParser::word(size_t offset) const {
+    unsigned value;
+    std::memcpy(&value, image.data() + offset, sizeof(value));
+    return value;
+}
+
+std::string_view DMappedArgumentParser::imageString(size_t offset) const {
+    return image.substr(word(ImageStringsOffset * sizeof(unsigned)) + word(offset), word(offset + sizeof(unsigned)));
+}
+
+int DMappedArgumentParser::findEntry(size_t tableOffset, unsigned entryCount, std::string_view key) const {
+    size_t first = 0, count = entryCount;
+    while (count > 0) {
+        size_t step = count / 2;
+        if (imageString(tableOffset + (first + step) * schemaImageEntrySize) < key) {
+            first += step + 1;
+            count -= step + 1;
+        } else
+            count = step;
+    }
+    if (first == entryCount || imageString(tableOffset + first * schemaImageEntrySize) != key)
+        return -1;
+    return (int) word(tableOffset + first * schemaImageEntrySize + 2 * sizeof(unsigned));
+}
+
+int DMappedArgumentParser::findOption(char command) const {
+    if (optionCount == 0)
+        return -1;
+    return (int) word(word(ImageShortIndexOffset * sizeof(unsigned)) + (unsigned char) command * sizeof(unsigned));
+}
+
+int DMappedArgumentParser::findOption(std::string_view command) const {
+    if (longCommandCount == 0)
+        return -1;
+    return findEntry(word(ImageLongIndexOffset * sizeof(unsigned)), longCommandCount, command);
+}
+
+int DMappedArgumentParser::findEnvironmentVariable(std::string_view name) const {
+    if (environmentCount == 0)
+        return -1;
+    return findEntry(word(ImageEnvironmentIndexOffset * sizeof(unsigned)), environmentCount, name);
+}
+
+bool DMappedArgumentParser::load(std::string_view _image) {
+    resetParsedValues();
+    image = {};
+    optionCount = longCommandCount = environmentCount = 0;
+    sortedLongCommands.clear();
+    const size_t headerSize = ImageHeaderSize * sizeof(unsigned);
+    if (_image.size() < headerSize)
+        return false;
+    image = _image;
+    auto header = [this](SchemaImageHeader position) { return (size_t) word(position * sizeof(unsigned)); };
+    size_t options = header(ImageOptionCount), longCommands = header(ImageLongCommandCount), environmentVariables = header(ImageEnvironmentCount), stringsSize = header(ImageStringsSize);
+    auto fits = [this](size_t offset, size_t size) { return offset <= image.size() && size <= image.size() - offset; };
+    auto stringFits = [this, stringsSize](size_t offset) { return word(offset) <= stringsSize && word(offset + sizeof(unsigned)) <= stringsSize - word(offset); };
+    bool isValid = header(ImageMagic) == schemaImageMagic && header(ImageVersion) == schemaImageVersion && header(ImageSize) == image.size() && fits(header(ImageStringsOffset), stringsSize) && fits(header(ImageOptionsOffset), options * schemaImageEntrySize) && fits(header(ImageShortIndexOffset), 256 * sizeof(unsigned)) && fits(header(ImageLongIndexOffset), longCommands * schemaImageEntrySize) && fits(header(ImageEnvironmentIndexOffset), environmentVariables * schemaImageEntrySize) && stringFits(ImageHelpText * sizeof(unsigned)) && stringFits(ImageVersionText * sizeof(unsigned));
+    for (size_t index = 0; isValid && index < options; index++) {
+        size_t record = header(ImageOptionsOffset) + index * schemaImageEntrySize;
+        isValid = (word(record) & 0xFF) <= (unsigned) DArgumentOptionType::VersionOption && (word(record) >> 8 & 0xFF) <= (unsigned) DArgumentValueType::ByteSize && (word(record) >> 16) <= 1 && stringFits(record + sizeof(unsigned));
+    }
+    for (size_t command = 0; isValid && command < 256; command++) {
+        unsigned option = word(header(ImageShortIndexOffset) + command * sizeof(unsigned));
+        isValid = option == (unsigned) -1 || option < options;
+    }
+    //both tables are binary searched, so they also have to be sorted
+    for (auto [tableOffset, entryCount]: {std::pair{header(ImageLongIndexOffset), longCommands}, std::pair{header(ImageEnvironmentIndexOffset), environmentVariables}})
+        for (size_t index = 0; isValid && index < entryCount; index++) {
+            size_t entry = tableOffset + index * schemaImageEntrySize;
+            isValid = stringFits(entry) && word(entry + 2 * sizeof(unsigned)) < options && (index == 0 || imageString(entry - schemaImageEntrySize) < imageString(entry));
+        }
+    if (!isValid) {
+        image = {};
+        return false;
+    }
+    optionCount = (unsigned) options;
+    longCommandCount = (unsigned) longCommands;
+    environmentCount = (unsigned) environmentVariables;
+    expandResponseFiles = header(ImageFlags) & schemaImageResponseFilesFlag;
+    allowAbbreviations = header(ImageFlags) & schemaImageAbbreviationsFlag;
+    optionSlots.assign(optionCount, -1);
+    foundOptions.reserve(optionCount);
+    foundOptionIndexes.reserve(optionCount);
+    if (allowAbbreviations)
+        for (size_t index = 0; index < longCommandCount; index++)
+            sortedLongCommands.push_back(imageString(header(ImageLongIndexOffset) + index * schemaImageEntrySize));
+    return true;
+}
+
+void DMappedArgumentParser::resetParsedValues() {
+    for (int index: foundOptionIndexes)
+        optionSlots[index] = -1;
+    foundOptions.clear();
+    foundOptionIndexes.clear();
+    arguments.clear();
+    responseFiles.clear();
+    positionalArgsViews.clear();
+    errorText.clear();
+    ambiguousCandidates.clear();
+}
+
+bool DMappedArgumentParser::Open(const std::string &path) {
+    DMappedFile mappedFile;
+    if (!mappedFile.Open(path)) {
+        load({});
+        return false;
+    }
+    file = std::move(mappedFile);
+    return load(std::string_view(file.Data(), file.Size()));
+}
+
+bool DMappedArgumentParser::Load(std::string_view _image) {
+    file.Close();
+    return load(_image);
+}
+
+bool DMappedArgumentParser::IsValid() const {
+    return !image.empty();
+}
+
+size_t DMappedArgumentParser::OptionCount() const {
+    return optionCount;
+}
+
+DParseResult DMappedArgumentParser::Parse() {
+    resetParsedValues();
+    DArgumentParser::ParseState state{argumentCount, argumentValues, expandResponseFiles, allowAbbreviations ? &sortedLongCommands : nullptr, arguments, responseFiles, positionalArgsViews, errorText, ambiguousCandidates};
+    ImageCommandIndex commandIndex(*this);
+    DParseResult parseResult = DArgumentParser::parseArguments(commandIndex, state);
+    if (parseResult != DParseResult::ParseSuccessful || environmentCount == 0)
+        return parseResult;
+    return DArgumentParser::parseEnvironment(environ, [this, &commandIndex](std::string_view name) {
+        return commandIndex.found(findEnvironmentVariable(name));
+    }, state);
+}
+
+int DMappedArgumentParser::WasSet(char command) const {
+    return Get(command).WasSet();
+}
+
+int DMappedArgumentParser::WasSet(std::string_view command) const {
+    return Get(command).WasSet();
+}
+
+const DArgumentOption &DMappedArgumentParser::Get(char command) const {
+    int index = findOption(command);
+    return index < 0 || optionSlots[index] < 0 ? unsetOption : foundOptions[optionSlots[index]];
+}
+
+const DArgumentOption &DMappedArgumentParser::Get(std::string_view command) const {
+    int index = findOption(command);
+    return index < 0 || optionSlots[index] < 0 ? unsetOption : foundOptions[optionSlots[index]];
+}
+
+const std::pmr::vector<std::string_view> &DMappedArgumentParser::GetPositionalArgumentViews() const {
+    return positionalArgsViews;
+}
+
+const std::pmr::vector<std::string_view> &DMappedArgumentParser::GetAmbiguousCandidates() const {
+    return ambiguousCandidates;
+}
+
+std::string_view DMappedArgumentParser::HelpText() const {
+    return image.empty() ? std::string_view() : imageString(ImageHelpText * sizeof(unsigned));
+}
+
+std::string_view DMappedArgumentParser::VersionText() const {
+    return image.empty() ? std::string_view() : imageString(ImageVersionText * sizeof(unsigned));
+}
+
+std::string DMappedArgumentParser::ErrorText() const {
+    return std::string(errorText);
 }
@@ -2,16 +2,35 @@
 #define DARGUMENTPARSER_LIBRARY_H
 
 #include <string>
+#include <string_view>
+#include <chrono>
+#include <cstdio>
 #include <vector>
+#include <deque>
+#include <list>
+#include <array>
 #include <set>
 #include <unordered_set>
+#include <unordered_map>
+#include <memory>
+#include <functional>
+#include <variant>
+#include <memory_resource>
+
+#include "DMappedFile.h"
+#include "DCommandTokenizer.h"
 
 enum class DParseResult : unsigned char {
     ParseSuccessful,
     InvalidOption,
     ValuePassedToOptionThatDoesNotTakeValue,
     NoValueWasPassedToOption,
-    OptionsThatTakesValueNeedsToBeSetSeparately
+    OptionsThatTakesValueNeedsToBeSetSeparately,
+    InvalidResponseFile,
+    InvalidValue,
+    AmbiguousOption,
+    InvalidConfigFile,
+    InvalidSubcommand
 };
 
 enum class DArgumentOptionType : unsigned char {
@@ -21,15 +40,106 @@ enum class DArgumentOptionType : unsigned char {
     VersionOption
 };
 
+/**
+ * How the value of an InputOption is interpreted, every type other than String is converted once during parsing.
+ * @def Integer - signed base 10 integer, e.g. "-42".
+ * @def FloatingPoint - e.g. "3.5", "1e-3".
+ * @def Boolean - true/false, yes/no, on/off or 1/0 (case insensitive).
+ * @def Duration - number followed by one of the suffixes ns, us, ms, s, m, h or d, without a suffix the number is in seconds, e.g. "1.5s", "250ms".
+ * @def ByteSize - number followed by one of the suffixes B, K, M, G, T (powers of 1024, KiB/MiB/GiB/TiB are also accepted) or kB, MB, GB, TB (powers of 1000), e.g. "64K", "1.5GB". Suffixes are case sensitive, so "KB" or "k" are rejected.
+ */
+enum class DArgumentValueType : unsigned char {
+    String,
+    Integer,
+    FloatingPoint,
+    Boolean,
+    Duration,
+    ByteSize
+};
+
+/**
+ * Where the value of an option came from, when an option is found in more than one place the first one in this order is used.
+ * @def CommandLine - argv, or the command string.
+ * @def Environment - the environment variable of the option (see DArgumentOption::SetEnvironmentVariable).
+ * @def ConfigFile - the config file loaded by DArgumentParser::LoadConfigFile.
+ */
+enum class DValueSource : unsigned char {
+    NotSet,
+    CommandLine,
+    Environment,
+    ConfigFile
+};
+
+/**
+ * Shells DArgumentParser::WriteCompletionScript can write a completion script for.
+ */
+enum class DCompletionShell : unsigned char {
+    Bash,
+    Zsh,
+    Fish
+};
+
+/**
+ * Read only view of contiguous values, such as every value passed to an option (see DArgumentOption::GetValues), valid until the next parse.
+ */
+class DValueRange {
+    const std::string_view *first = nullptr;
+    size_t count = 0;
+
+public:
+    DValueRange() = default;
+
+    DValueRange(const std::string_view *_first, size_t _count) : first(_first), count(_count) {}
+
+    [[nodiscard]] const std::string_view *begin() const { return first; }
+
+    [[nodiscard]] const std::string_view *end() const { return first + count; }
+
+    [[nodiscard]] const std::string_view *data() const { return first; }
+
+    [[nodiscard]] size_t size() const { return count; }
+
+    [[nodiscard]] bool empty() const { return count == 0; }
+
+    const std::string_view &operator[](size_t index) const { return first[index]; }
+};
+
 class DArgumentOption {
     friend class DArgumentParser;
+    friend class DArgumentSchema;
 
     DArgumentOptionType type = DArgumentOptionType::NormalOption;
+    DArgumentValueType valueType = DArgumentValueType::String;
+    DValueSource valueSource = DValueSource::NotSet;
     int wasSet = 0;
-    std::string value;
+    std::string_view valueView;
+    mutable std::string value;
+    long long integerValue = 0;
+    unsigned long long byteSizeValue = 0;
+    double floatingPointValue = 0;
+    bool booleanValue = false;
+    std::chrono::nanoseconds durationValue{0};
     std::set<char> shortCommands;
     std::set<std::string> longCommands;
     std::string description;
+    std::string environmentVariable;
+    unsigned revision = 0;
+    bool multipleValues = false;
+    std::vector<std::string_view> values;
+    void *boundVariable = nullptr;
+    std::variant<std::monostate, bool, int, long long, double, std::chrono::nanoseconds, unsigned long long, std::string> boundDefault;
+
+    bool setValue(std::string_view _value);
+
+    void resetValue();
+
+    /**
+     * Writes the results of the option to the bound variable (if any), or the value it had when it was bound if the option isn't set.
+     */
+    void writeBinding() const;
+
+    template<typename Variable>
+    bool bind(Variable &variable, bool isNormalOptionAllowed, DArgumentValueType inputValueType);
 
 public:
 
@@ -86,63 +196,621 @@ public:
 
     [[nodiscard]] DArgumentOptionType GetType() const;
 
+    /**
+     * Sets how the value passed to this option should be converted, only used by DArgumentOptionType::InputOption.
+     * <br>If the value can't be converted the parse fails with DParseResult::InvalidValue.
+     */
+    void SetValueType(DArgumentValueType _valueType);
+
+    [[nodiscard]] DArgumentValueType GetValueType() const;
+
+    /**
+     * <br>Makes an InputOption keep every value passed to it (e.g. "-I a -I b"), in the order they were passed, instead of only the last one. The values are views into argv, stored contiguously (see GetValues).
+     * <br>GetValue and the converted values still return the last value, every value is converted and checked though.
+     */
+    void SetMultipleValues(bool enabled);
+
+    [[nodiscard]] bool HasMultipleValues() const;
+
+    /**
+     * <br>Sets the environment variable read by DArgumentParser::Parse when the option isn't passed in the command line, replacing the previous one (an empty name removes it).
+     * <br>For InputOptions the variable holds the value, for the other types it's read as a boolean (see DArgumentValueType::Boolean) and only sets the option if true. Empty variables are ignored.
+     * <br>Like the commands, it should be set before the option is added to a parser.
+     * @return false if the name is invalid(1), otherwise true.
+     * @def invalid(1) - has an equal(=) sign.
+     */
+    bool SetEnvironmentVariable(const std::string &name);
+
+    [[nodiscard]] const std::string &EnvironmentVariable() const;
+
     [[nodiscard]] int WasSet() const;
 
+    /**
+     * @return Returns where the option was set from by the last parse, DValueSource::NotSet if it wasn't set.
+     * <br>Options that don't take a value and were turned off by their environment variable ("0", "false"...) return DValueSource::Environment while WasSet returns 0.
+     */
+    [[nodiscard]] DValueSource GetValueSource() const;
+
+    /**
+     * @return Returns the value passed to this option, the string is only created on the first call after parsing.
+     */
     [[nodiscard]] const std::string &GetValue() const;
+
+    /**
+     * @return Returns a view of the value passed to this option, pointing directly into the argv passed to the parser.
+     */
+    [[nodiscard]] std::string_view GetValueView() const;
+
+    /**
+     * @return Returns every value passed to the option if it keeps multiple values (see SetMultipleValues), otherwise the last value (if it was set).
+     */
+    [[nodiscard]] DValueRange GetValues() const;
+
+    /**
+     * @return Returns the converted value if the value type is DArgumentValueType::Integer, otherwise 0.
+     */
+    [[nodiscard]] long long GetIntegerValue() const;
+
+    /**
+     * @return Returns the converted value if the value type is DArgumentValueType::FloatingPoint, otherwise 0.
+     */
+    [[nodiscard]] double GetFloatingPointValue() const;
+
+    /**
+     * @return Returns the converted value if the value type is DArgumentValueType::Boolean, otherwise false.
+     */
+    [[nodiscard]] bool GetBooleanValue() const;
+
+    /**
+     * @return Returns the converted value if the value type is DArgumentValueType::Duration, otherwise 0.
+     */
+    [[nodiscard]] std::chrono::nanoseconds GetDurationValue() const;
+
+    /**
+     * @return Returns the converted value, in bytes, if the value type is DArgumentValueType::ByteSize, otherwise 0.
+     */
+    [[nodiscard]] unsigned long long GetByteSizeValue() const;
+
+    /**
+     * <br>Binds the option to a variable, which parses through a DArgumentParser write to as soon as the option is set, so the results don't have to be looked up and copied after parsing.
+     * <br>The value the variable holds when it's bound is its default, written back whenever a parse starts or the option is unset. The variable must outlive the binding, and only one variable is bound at a time.
+     * <br>For DArgumentOptionType::NormalOption a bool is set to true and an int (or long long) counts how many times the option was passed. For InputOptions the value type is set to match the variable: Boolean, Integer, FloatingPoint, Duration or ByteSize (unsigned long long), while a std::string receives the value as passed, keeping the value type.
+     * <br>Integers that don't fit in an int make the parse fail with DParseResult::InvalidValue. DArgumentSchema outcomes never write to bound variables.
+     * @return false if the option can't write to this type of variable (NormalOptions only take bool, int and long long), in which case the previous binding is kept.
+     */
+    bool Bind(bool &variable);
+
+    bool Bind(int &variable);
+
+    bool Bind(long long &variable);
+
+    bool Bind(double &variable);
+
+    bool Bind(std::chrono::nanoseconds &variable);
+
+    bool Bind(unsigned long long &variable);
+
+    bool Bind(std::string &variable);
+
+    /**
+     * Binds the option to a member of a config struct, e.g. Bind(config, &Config::verbose).
+     */
+    template<typename Config, typename Member>
+    bool Bind(Config &config, Member Config::*member) {
+        return Bind(config.*member);
+    }
+
+    /**
+     * Removes the binding, leaving the variable as it is.
+     */
+    void Unbind();
+};
+
+/**
+ * A value passed in the command line to an option that keeps multiple values, see DArgumentParser::GetOccurrences.
+ */
+struct DArgumentOccurrence {
+    const DArgumentOption *option;
+    std::string_view value;
+};
+
+/**
+ * What parsing (or rendering the help text) cost, recorded by DArgumentParser when the library is built with DARGUMENTPARSER_INSTRUMENTATION, otherwise every field stays 0.
+ * @def tokenizeTime - collecting the arguments: reading argv, splitting command strings and expanding response files.
+ * @def lookupTime - going through the arguments and looking the commands up, without the time spent in valueAssignmentTime.
+ * @def valueAssignmentTime - storing and converting the values of InputOptions, from the command line, the environment and the config file.
+ * @def helpGenerationTime - rendering the help text with WriteHelp (or HelpText, when it isn't cached).
+ * @def tokens - arguments parsed, without the executable name.
+ * @def lookupProbes - lookups made in the command, abbreviation and environment indexes.
+ * @def allocations - allocations made from the memory resource of the parser.
+ * @def errors - parses that didn't return DParseResult::ParseSuccessful.
+ * @def parses - calls to Parse, ParseCommandString, ParseLazily, Validate and the argument edits (BeginArgumentEditing, AppendArgument...).
+ */
+struct DParseStatistics {
+    std::chrono::nanoseconds tokenizeTime{0};
+    std::chrono::nanoseconds lookupTime{0};
+    std::chrono::nanoseconds valueAssignmentTime{0};
+    std::chrono::nanoseconds helpGenerationTime{0};
+    size_t tokens = 0;
+    size_t lookupProbes = 0;
+    size_t allocations = 0;
+    size_t errors = 0;
+    size_t parses = 0;
+
+    DParseStatistics &operator+=(const DParseStatistics &other);
+};
+
+/**
+ * Destination of the text written by DArgumentParser::WriteHelp.
+ * <br>The views passed to Write stay valid until Flush is called, as long as the parser and its options aren't changed in the meantime, so implementations may hold them instead of copying.
+ */
+class DHelpSink {
+public:
+    virtual ~DHelpSink() = default;
+
+    virtual void Write(std::string_view text) = 0;
+
+    virtual void Flush() {}
+};
+
+/**
+ * Appends the help text to a string.
+ */
+class DStringHelpSink : public DHelpSink {
+    std::string &output;
+
+public:
+    explicit DStringHelpSink(std::string &_output);
+
+    void Write(std::string_view text) override;
 };
 
+/**
+ * Writes the help text to a FILE* (stdout, stderr...), the file is flushed at the end.
+ */
+class DFileHelpSink : public DHelpSink {
+    FILE *file;
+
+public:
+    explicit DFileHelpSink(FILE *_file);
+
+    void Write(std::string_view text) override;
+
+    void Flush() override;
+};
+
+/**
+ * Writes the help text to a file descriptor, batching the pieces of text and writing them with a single writev call per batch.
+ */
+class DFileDescriptorHelpSink : public DHelpSink {
+    static constexpr int pendingBatchSize = 64;
+    int fileDescriptor;
+    std::array<std::string_view, pendingBatchSize> pending;
+    int pendingCount = 0;
+
+public:
+    explicit DFileDescriptorHelpSink(int _fileDescriptor);
+
+    ~DFileDescriptorHelpSink() override;
+
+    void Write(std::string_view text) override;
+
+    void Flush() override;
+};
+
+class DArgumentSchema;
+
 class DArgumentParser {
+    friend class DArgumentSchema;
+    friend class DMappedArgumentParser;
+
+    /**
+     * A "key = value" line of the config file, both views point into the mapped file.
+     */
+    struct ConfigEntry {
+        std::string_view key;
+        std::string_view value;
+        bool hasValue;
+    };
+
+    /**
+     * A subcommand added with AddSubcommand, its parser is only created (and filled by the factory) the first time the subcommand is used.
+     */
+    struct SubcommandEntry {
+        std::pmr::string name;
+        std::pmr::string description;
+        std::function<void(DArgumentParser &)> factory;
+        std::pmr::string executableName;
+        char *argumentValues[2]{};
+        DArgumentParser *parser = nullptr;
+
+        SubcommandEntry(std::string_view _name, std::string_view _description, std::function<void(DArgumentParser &)> _factory, std::string_view parentExecutableName, std::pmr::memory_resource *memoryResource);
+    };
+
+    /**
+     * Counts the allocations made from the memory resource of the parser, only created when built with DARGUMENTPARSER_INSTRUMENTATION.
+     */
+    class AllocationCounter : public std::pmr::memory_resource {
+        std::pmr::memory_resource *upstream;
+
+        void *do_allocate(size_t bytes, size_t alignment) override;
+
+        void do_deallocate(void *pointer, size_t bytes, size_t alignment) override;
+
+        [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+    public:
+        size_t allocations = 0;
+
+        explicit AllocationCounter(std::pmr::memory_resource *_upstream);
+    };
+
     int argumentCount;
     char **argumentValues;
-    const std::string executableName;
-    std::string appName;
-    std::string appVersion;
-    std::string appDescription;
-    std::unordered_set<DArgumentOption *> argumentOptions;
-    std::vector<std::tuple<std::string, std::string, std::string>> positionalArgs;
-    std::vector<std::string> positionalArgsValues;
-    std::string errorText;
+    std::unique_ptr<AllocationCounter> allocationCounter;
+    //the resource the storage of the parser is allocated from, the allocation counter (if there's one) or the resource passed on creation
+    std::pmr::memory_resource *storage;
+    const std::pmr::string executableName;
+    std::pmr::string appName;
+    std::pmr::string appVersion;
+    std::pmr::string appDescription;
+    DParseStatistics currentStatistics;
+    DParseStatistics totalStatistics;
+    std::function<void(const DParseStatistics &)> statisticsObserver;
+    std::pmr::unordered_set<DArgumentOption *> argumentOptions;
+    std::array<DArgumentOption *, 256> shortCommandIndex{};
+    std::pmr::unordered_map<std::string_view, DArgumentOption *> longCommandIndex;
+    std::pmr::unordered_map<std::string_view, DArgumentOption *> environmentIndex;
+    char **environment = nullptr;
+    DMappedFile configFile;
+    std::pmr::string configFilePath;
+    std::pmr::vector<ConfigEntry> configEntries;
+    std::pmr::vector<std::tuple<std::pmr::string, std::pmr::string, std::pmr::string>> positionalArgs;
+    std::pmr::vector<std::string_view> positionalArgsViews;
+    mutable std::vector<std::string> positionalArgsValues;
+    std::pmr::string errorText;
+    bool expandResponseFiles = false;
+    bool allowAbbreviations = false;
+    bool sortedLongCommandsIsDirty = true;
+    std::pmr::vector<std::string_view> sortedLongCommands;
+    std::pmr::vector<std::string_view> ambiguousCandidates;
+    std::pmr::vector<std::string_view> arguments;
+    std::pmr::vector<DMappedFile> responseFiles;
+    //the bytes of the arguments a subcommand parser got from its parent, copied so they outlive the next parse of the parent
+    std::pmr::string inheritedArgumentText;
+    std::pmr::string registrationErrorText;
+    std::pmr::string commandString;
+    std::pmr::vector<std::string_view> commandStringArguments;
+    std::string helpText;
+    std::string versionText;
+    bool helpLayoutIsDirty = true;
+    bool helpTextIsDirty = true;
+    bool versionTextIsDirty = true;
+    size_t helpLayoutOptionsRevision = 0;
+    std::pmr::vector<DArgumentOption *> helpAndVersionOptionsLayout;
+    std::pmr::vector<DArgumentOption *> normalOptionsLayout;
+    int helpAndVersionOptionsColumnSize = 0;
+    int normalOptionsColumnSize = 0;
+    int positionalArgsColumnSize = 0;
+    std::pmr::deque<SubcommandEntry> subcommands;
+    //created the first time their subcommand is used, a list keeps them in place
+    std::pmr::list<DArgumentParser> subcommandParsers;
+    std::pmr::unordered_map<std::string_view, SubcommandEntry *> subcommandIndex;
+    SubcommandEntry *selectedSubcommand = nullptr;
+    int subcommandsColumnSize = 0;
+    bool lazyParsePending = false;
+    DParseResult lazyParseResult = DParseResult::ParseSuccessful;
+    std::pmr::vector<int> lazyCommandTokens;
+    std::pmr::unordered_set<DArgumentOption *> lazyResolvedOptions;
+    //the entries of the environment that belong to an option, filtered once per lazy parse and terminated by nullptr like environ (empty until then)
+    std::pmr::vector<char *> lazyEnvironment;
+
+    /**
+     * The values an option had before an edited argument changed them.
+     */
+    struct OptionSnapshot {
+        DArgumentOption *option;
+        int wasSet;
+        DValueSource valueSource;
+        std::string_view valueView;
+        size_t valueCount;
+        long long integerValue;
+        unsigned long long byteSizeValue;
+        double floatingPointValue;
+        bool booleanValue;
+        std::chrono::nanoseconds durationValue;
+    };
+
+    /**
+     * What parsing the edited arguments from firstArgument up to endArgument (a command and its value, or a positional argument) changed, so it can be rolled back.
+     * @def firstSnapshot - position in optionSnapshots of the first option it changed.
+     */
+    struct ArgumentJournalEntry {
+        int firstArgument;
+        int endArgument;
+        size_t firstSnapshot;
+        size_t positionalArgsCount;
+        size_t occurrenceCount;
+        DParseResult result;
+    };
+
+    /**
+     * An edit of the argument list, the arguments it removed are kept at the end of removedArguments until it's undone.
+     */
+    struct ArgumentEdit {
+        size_t appendedCount;
+        size_t removedCount;
+    };
+
+    bool isEditingArguments = false;
+    DParseResult editParseResult = DParseResult::ParseSuccessful;
+    //the entries of the environment that belong to an option (terminated by nullptr) and the options the fallback sources can set, found once by BeginArgumentEditing
+    std::pmr::vector<char *> editEnvironment;
+    std::pmr::vector<DArgumentOption *> editFallbackOptions;
+    std::pmr::deque<std::pmr::string> editedArguments;
+    std::pmr::vector<ArgumentJournalEntry> argumentJournal;
+    std::pmr::vector<OptionSnapshot> optionSnapshots;
+    std::pmr::vector<ArgumentEdit> argumentEdits;
+    std::pmr::vector<std::pmr::string> removedArguments;
+    std::pmr::vector<DArgumentOccurrence> occurrences;
+    /**
+     * A long command of the table suggestions are looked for in, with a mask of the characters it contains (each character sets bit c % 64).
+     */
+    struct SuggestionEntry {
+        std::string_view command;
+        unsigned long long characters;
+    };
 
-    static std::string getExecutableName(char *execCall);
+    bool suggestionTableIsDirty = true;
+    std::pmr::vector<SuggestionEntry> suggestionTable;
+    std::pmr::vector<unsigned> suggestionLengthStarts;
+    std::pmr::vector<std::string_view> suggestions;
 
-    static std::vector<int> calculateSizeOfOptionStrings(const std::vector<DArgumentOption *> &args);
+    class OptionLine;
 
-    static std::vector<std::string> generateOptionStrings(const std::vector<DArgumentOption *> &args, const std::vector<int> &sizes, int columnSize);
+    class LazyCommandIndex;
 
-    static std::string generateOptionsSubSection(const std::vector<DArgumentOption *> &args, const char *openingString);
+    class JournalCommandIndex;
 
-    static bool isLongCommand(const std::string &argument);
+    /**
+     * Everything a parse reads from and writes to, other than the options themselves, so the same parsing code can fill either the parser or a DParseOutcome.
+     */
+    struct ParseState {
+        int argumentCount;
+        char **argumentValues;
+        bool expandResponseFiles;
+        const std::pmr::vector<std::string_view> *sortedLongCommands;
+        std::pmr::vector<std::string_view> &arguments;
+        std::pmr::vector<DMappedFile> &responseFiles;
+        std::pmr::vector<std::string_view> &positionalArgsViews;
+        std::pmr::string &errorText;
+        std::pmr::vector<std::string_view> &ambiguousCandidates;
+        bool stopAtFirstPositional = false;
+        int firstUnparsedArgument = 0;
+        DParseStatistics *statistics = nullptr;
+        std::pmr::vector<DArgumentOccurrence> *occurrences = nullptr;
+        std::string_view invalidCommand;
+
+        ParseState(int _argumentCount, char **_argumentValues, bool _expandResponseFiles, const std::pmr::vector<std::string_view> *_sortedLongCommands, std::pmr::vector<std::string_view> &_arguments, std::pmr::vector<DMappedFile> &_responseFiles, std::pmr::vector<std::string_view> &_positionalArgsViews, std::pmr::string &_errorText, std::pmr::vector<std::string_view> &_ambiguousCandidates);
+    };
+
+    class PhaseTimer;
+
+    static std::unique_ptr<AllocationCounter> createAllocationCounter(std::pmr::memory_resource *memoryResource);
+
+    /**
+     * Starts recording the statistics of a parse or help rendering into currentStatistics.
+     */
+    void beginStatistics();
+
+    /**
+     * Adds currentStatistics to the totals and passes them to the observer.
+     * @return Returns the result passed to it.
+     */
+    DParseResult finishStatistics(DParseResult result, bool isParse = true);
 
-    static bool isShortCommand(const std::string &argument);
+    static std::string_view getExecutableName(const char *execCall);
 
-    bool checkIfArgumentIsUnique(DArgumentOption *dArgumentOption);
+    static int calculateSizeOfOptionString(const DArgumentOption *arg);
 
-    bool checkIfAllArgumentsInListAreUnique(const std::unordered_set<DArgumentOption *> &_arguments);
+    static bool optionLineIsLess(const DArgumentOption *first, const DArgumentOption *second, int columnSize);
 
-    std::string generateUsageSection();
+    static int layoutOptionsSubSection(std::pmr::vector<DArgumentOption *> &args);
 
-    std::string generateDescriptionSection();
+    static void writeOptionsSubSection(DHelpSink &sink, const std::pmr::vector<DArgumentOption *> &args, int columnSize, const char *openingString);
 
-    void calculateSizeOfArgumentsString(std::vector<int> &sizes);
+    static int calculateSizeOfArgumentString(const std::tuple<std::pmr::string, std::pmr::string, std::pmr::string> &arg);
 
-    std::string generatePositionalArgsSection();
+    static bool isLongCommand(std::string_view argument);
 
-    std::string generateOptionsSection();
+    static bool isShortCommand(std::string_view argument);
+
+    /**
+     * Checks the option against the command index, writing the reason into registrationErrorText if it can't be added.
+     * @param batch the options being added together with it, if any, only used to describe the collision.
+     */
+    bool checkIfArgumentIsUnique(DArgumentOption *dArgumentOption, const std::unordered_set<DArgumentOption *> *batch = nullptr);
+
+    void addToCommandIndex(DArgumentOption *dArgumentOption);
+
+    /**
+     * Removes the index entries of the options that are no longer part of the parser, found by the option each entry points to rather than by the option's commands.
+     */
+    void pruneCommandIndex();
 
-    void generateErrorText(DParseResult error, const std::string &command);
+    bool updateHelpLayout();
 
-    void generateErrorText(DParseResult error, char command);
+    void writeUsageSection(DHelpSink &sink) const;
+
+    void writeDescriptionSection(DHelpSink &sink) const;
+
+    void writePositionalArgsSection(DHelpSink &sink) const;
+
+    void writeSubcommandsSection(DHelpSink &sink) const;
+
+    size_t optionsRevision() const;
+
+    /**
+     * Clears everything the last parse left behind, other than the values of the options.
+     */
+    void resetParseState();
 
     void resetParsedValues();
 
-    DParseResult parseLongCommand(const std::string &argument, int &currentIndex);
+    /**
+     * Sets the option from the commands recorded by ParseLazily (and then from the fallback sources), the first time it's queried after it.
+     */
+    void resolveLazily(DArgumentOption *arg);
+
+    /**
+     * Fills entries with the entries of the environment whose variable belongs to an option, followed by nullptr like environ.
+     */
+    void filterEnvironment(std::pmr::vector<char *> &entries) const;
+
+    /**
+     * Undoes the changes of the last argument parsed by parseEditedArguments, restoring the options it changed and the positional arguments.
+     */
+    void rollBackArgument();
 
-    DParseResult parseShortCommand(const std::string &argument, int &currentIndex);
+    /**
+     * Unsets the options the environment and the config file set after the last edit, the command line may no longer leave them unset.
+     */
+    void rollBackFallbackSources();
+
+    /**
+     * Parses the edited arguments after the last one in the journal, a failed argument is parsed again since the edit may have completed it. Parsers with subcommands are parsed in full.
+     */
+    DParseResult parseEditedArguments();
+
+    /**
+     * Keeps the first keptCount edited arguments, rolling back the journal of the others, and parses the arguments appended after them.
+     * @param isUndoable whether the edit is recorded so UndoArgumentEdit can revert it.
+     */
+    DParseResult editArguments(size_t keptCount, const std::string_view *appended, size_t appendedCount, bool isUndoable);
+
+    /**
+     * @return Returns the long commands in alphabetical order, sorting them again if options were added or removed.
+     */
+    const std::pmr::vector<std::string_view> &sortedLongCommandTable();
+
+    /**
+     * Sorts the long commands by their size into suggestionTable if options were added or removed, suggestionLengthStarts holds the position of the first command of each size.
+     */
+    void updateSuggestionTable();
+
+    /**
+     * Fills suggestions with the long commands closest to the invalid command of the state (if the result is DParseResult::InvalidOption), within a few edits, appending them to the error text. Only called once a parse failed.
+     * @return Returns the result passed to it.
+     */
+    DParseResult suggestCommands(DParseResult result, ParseState &state);
+
+    /**
+     * @return Returns the sorted list of long commands used to resolve abbreviations (see sortedLongCommandTable), or nullptr if abbreviations aren't allowed.
+     */
+    const std::pmr::vector<std::string_view> *updateSortedLongCommands();
+
+    static void writeCompletion(DHelpSink &sink, std::string_view prefix, std::string_view candidate, std::string_view description);
+
+    /**
+     * Writes the values an option can take that start with the given text, only booleans have a known list of values.
+     */
+    static void writeValueCompletions(DHelpSink &sink, const DArgumentOption *arg, std::string_view prefix, std::string_view value);
+
+    /**
+     * Writes the completions of the last word, the words before it (without the executable name) tell whether it's a value and which subcommand it belongs to.
+     */
+    void writeCompletions(DHelpSink &sink, char **words, int wordCount);
+
+    /**
+     * <br>Looks up a command that wasn't found as is, as an abbreviation of the sorted long commands.
+     * @return Returns the option if all the commands starting with the abbreviation belong to the same option, otherwise nullptr (the candidates are filled in if there's more than one option).
+     */
+    template<typename CommandIndex>
+    static DArgumentOption *findAbbreviation(const CommandIndex &commandIndex, std::string_view abbreviation, ParseState &state);
+
+    DArgumentOption *findLongCommand(std::string_view command) const;
+
+    /**
+     * Checks that every key of the config entries is a long command of an option, writing the error text for the first one that isn't.
+     */
+    DParseResult checkConfigKeys(const std::pmr::vector<ConfigEntry> &entries, std::string_view path);
+
+    DArgumentOption *findShortCommand(char command) const;
+
+    static DParseResult collectArguments(ParseState &state);
+
+    static DParseResult collectArgument(std::string_view argument, ParseState &state);
+
+    static DParseResult expandResponseFile(std::string_view path, int depth, ParseState &state);
+
+    /**
+     * Sets the value of the option, adding the time it took to the statistics of the state.
+     */
+    static bool assignValue(DArgumentOption *arg, std::string_view value, ParseState &state);
+
+    /**
+     * Parses the arguments of the state, CommandIndex is anything with findLongCommand and findShortCommand functions returning the DArgumentOption that receives the results (or nullptr if there's no such command).
+     */
+    template<typename CommandIndex>
+    static DParseResult parseArguments(const CommandIndex &commandIndex, ParseState &state);
+
+    /**
+     * Same as parseArguments, for when the arguments of the state were already filled in.
+     */
+    template<typename CommandIndex>
+    static DParseResult parseCollectedArguments(const CommandIndex &commandIndex, ParseState &state);
+
+    /**
+     * Sets the options that weren't set yet from the environment, going through it once, findEnvironmentVariable returns the option reading a variable (or nullptr).
+     */
+    template<typename FindEnvironmentVariable>
+    static DParseResult parseEnvironment(char **environmentVariables, const FindEnvironmentVariable &findEnvironmentVariable, ParseState &state);
+
+    DParseResult parseEnvironment(ParseState &state, char **environmentVariables);
+
+    /**
+     * Sets the options that weren't set by the command line or the environment from the entries of the config file.
+     * @param onlyOption if set, the entries of every other option are skipped.
+     */
+    DParseResult parseConfigFile(ParseState &state, const DArgumentOption *onlyOption = nullptr);
+
+    /**
+     * Fills the options the command line didn't set, from the environment first and then the config file.
+     * @param environmentVariables the entries read instead of the environment of the parser, if set.
+     */
+    DParseResult parseFallbackSources(ParseState &state, char **environmentVariables = nullptr);
+
+    DArgumentParser &subcommandParser(SubcommandEntry &subcommand);
+
+    /**
+     * Parses the arguments after the first positional argument with the parser of the subcommand it names.
+     */
+    DParseResult parseSubcommand(ParseState &state);
+
+    /**
+     * Everything a parse does after the command line itself was parsed: the fallback sources and then the subcommand, if any.
+     */
+    DParseResult completeParse(ParseState &state);
+
+    template<typename CommandIndex>
+    static DParseResult parseLongCommand(const CommandIndex &commandIndex, std::string_view argument, int &currentIndex, ParseState &state);
+
+    template<typename CommandIndex>
+    static DParseResult parseShortCommand(const CommandIndex &commandIndex, std::string_view argument, int &currentIndex, ParseState &state);
 
 public:
 
     DArgumentParser(int argc, char **argv, std::string _appName = std::string(), std::string _appVersion = std::string(), std::string _appDescription = std::string());
 
+    /**
+     * <br>Same as the constructor above, but all the storage owned by the parser (app info, option lists, lookup index, parsed arguments, positional arguments, error text, help layout and subcommands) is allocated from memoryResource.
+     * <br>With a std::pmr::monotonic_buffer_resource big enough for the schema and argv, Parse() makes no allocations from the global heap.
+     * <br>The options belong to the caller and keep their own storage, so they can be destroyed before the parser. Options that keep multiple values allocate their value list themselves, the first parse that passes them more values than before grows it.
+     * <br>The strings handed out by reference (HelpText, VersionText and GetPositionalArguments) also keep their own storage, none of them is allocated while parsing.
+     * @details memoryResource must outlive the parser.
+     */
+    DArgumentParser(int argc, char **argv, std::pmr::memory_resource *memoryResource, std::string _appName = std::string(), std::string _appVersion = std::string(), std::string _appDescription = std::string());
+
     void SetAppInfo(const std::string &name, const std::string &version, const std::string &description = std::string());
 
     void SetAppName(const std::string &name);
@@ -151,31 +819,80 @@ public:
 
     void SetAppDescription(const std::string &description);
 
+    /**
+     * <br>If enabled, every argument starting with an at(@) sign is treated as a response file: the file is read and its contents are parsed as if they were passed in place of the argument.
+     * <br>Arguments in the file are separated by whitespaces, single and double quotes can be used to keep whitespaces and a backslash escapes the next character (except inside single quotes). Response files can reference other response files.
+     * <br>Disabled by default.
+     */
+    void SetResponseFileExpansion(bool enabled);
+
+    /**
+     * <br>If enabled, long commands can be abbreviated to any prefix that belongs to a single option, e.g. --verb for --verbose (exact matches always take priority).
+     * <br>Prefixes shared by more than one option fail with DParseResult::AmbiguousOption, the commands it could be are listed in the error text and by GetAmbiguousCandidates.
+     * <br>Disabled by default.
+     */
+    void SetLongCommandAbbreviation(bool enabled);
+
+    /**
+     * <br>Sets the environment read by Parse for the options with an environment variable, in the same format as environ (and the optional third argument of main).
+     * <br>By default, or if set to nullptr, environ is used.
+     */
+    void SetEnvironment(char **_environment);
+
+    /**
+     * <br>Maps a config file whose entries are applied by every following parse, to the options the command line and the environment didn't set. Replaces the config file previously loaded.
+     * <br>Each line holds either a "key = value" entry, where the key is a long command of the option (without the minus signs), a "key" entry for options that don't take a value, a [section] header or a comment starting with # or ;.
+     * <br>Values can be quoted to keep leading and trailing whitespaces, and are read as booleans (see DArgumentValueType::Boolean) by options that don't take a value. Entries set later in the file override earlier ones.
+     * <br>Loading a file that has the same size and modification time as the one already loaded doesn't read it again, but its keys are checked again against the current options. If the file can't be loaded, the one loaded before stays in use.
+     * @return DParseResult::ParseSuccessful if it was loaded, DParseResult::InvalidConfigFile if the file couldn't be read or a line is malformed, DParseResult::InvalidOption if a key doesn't belong to any option. ErrorText() tells why.
+     */
+    DParseResult LoadConfigFile(const std::string &path);
+
+    /**
+     * Unmaps the config file, its entries are no longer applied.
+     */
+    void ClearConfigFile();
+
+    /**
+     * Creates an immutable copy of the argument options added so far (and of the response file and abbreviation settings), that can be shared by many threads to parse different command lines at the same time.
+     * <br>Changes made to the parser or to its options afterwards don't affect the schema.
+     */
+    [[nodiscard]] DArgumentSchema CreateSchema() const;
+
+    /**
+     * <br>Serializes the argument options added so far into a compact binary image, holding the command tables, lookup indexes, types, descriptions, environment variables, the help and version texts and the response file and abbreviation settings.
+     * <br>The image can be written to a file (or embedded into the program) and parsed with DMappedArgumentParser, without building any option at startup. It's only readable by machines with the same byte order.
+     */
+    [[nodiscard]] std::string CreateSchemaImage();
+
     /**
      * <br>if the argument is valid(1) then it will be added to the argument list.
-     * @return true if argument was added, false if it wasn't (invalid argument).
+     * @return true if argument was added, false if it wasn't (invalid argument, see RegistrationErrorText).
      * @def valid(1) - At least 1 command, either long or short, is set and all of its commands are unique (when compared to other DArgumentOptions added before).
      * @details Do not use in-place constructors as you won't be able to remove it later and clearing all the argumentOptions will result in the memory being leaked.
+     * <br>The option's commands are indexed when it's added, commands should not be added or removed from it while it's part of the parser.
      */
     bool AddArgumentOption(DArgumentOption *dArgumentOption);
 
     /**
      * <br>if the argument is valid(1) then it will be added to the argument list.
-     * @return true if argument was added, false if it wasn't (invalid argument).
+     * @return true if argument was added, false if it wasn't (invalid argument, see RegistrationErrorText).
      * @def valid(1) - At least 1 command, either long or short, is set and all of its commands are unique (when compared to other DArgumentOptions added before).
+     * <br>The option's commands are indexed when it's added, commands should not be added or removed from it while it's part of the parser.
      */
     bool AddArgumentOption(DArgumentOption &dArgumentOption) { return AddArgumentOption(&dArgumentOption); }
 
     /**
      * <br>if all argumentOptions are valid(1) then they will be added to the argument list.
-     * @return true if the argumentOptions were added, false if they were not. (at least one argument was invalid).
+     * @return true if the argumentOptions were added, false if they were not. (at least one argument was invalid, see RegistrationErrorText).
      * @def valid(1) - At least 1 command, either long or short, is set for each argument and all commands are unique (when compared to other DArgumentOptions added before and to each other).
+     * <br>The whole list is checked and added in a single pass, each command is looked up once in the command index.
      * @details Do not use in-place constructors for DArgumentOption as you won't be able to remove it later and clearing all the argumentOptions will result in the memory being leaked.
      */
     bool AddArgumentOption(std::unordered_set<DArgumentOption *> &&args);
 
     /**
-     * Removes the passed argument from the argument list.
+     * Removes the passed argument from the argument list, along with every command indexed for it (even if its commands changed since it was added).
      * @return true if it was removed, false if it wasn't (in case there was no such argument in the list).
      */
     bool RemoveArgumentOption(DArgumentOption *argument);
@@ -204,6 +921,26 @@ public:
      */
     void ClearPositionalArgumets();
 
+    /**
+     * <br>Adds a git-style subcommand, selected by the first positional argument. The options before it are parsed by this parser and everything after it by the parser of the subcommand.
+     * <br>The factory is only called the first time the subcommand is used, with the (empty) parser of the subcommand, so the options of every other subcommand are never built. Options added by the factory need to outlive this parser.
+     * <br>Once any subcommand is added, a first positional argument that doesn't name one makes the parse fail with DParseResult::InvalidSubcommand.
+     * @return false if the name is invalid(1) or already used by another subcommand (RegistrationErrorText tells which), otherwise true.
+     * @def invalid(1) - empty, contains whitespaces or starts with a minus(-) or at(@) sign.
+     */
+    bool AddSubcommand(const std::string &name, const std::string &description, std::function<void(DArgumentParser &)> factory);
+
+    /**
+     * @return Returns the name of the subcommand selected by the last parse, or an empty view if none was.
+     */
+    [[nodiscard]] std::string_view SelectedSubcommand() const;
+
+    /**
+     * <br>The subcommand parser keeps its own copy of its arguments, so its results stay valid when this parser parses again, until the subcommand is selected again.
+     * @return Returns the parser of the subcommand selected by the last parse (holding its options, positional arguments and errors), or nullptr if none was.
+     */
+    [[nodiscard]] DArgumentParser *SubcommandParser() const;
+
     /**
      * @param command the command character to check.
      * @return Returns a boolean indicating if the option was set or not, always returns false if no option with specified command was found.
@@ -216,23 +953,463 @@ public:
      */
     [[nodiscard]] int WasSet(const std::string &command);
 
+    /**
+     * @return Returns the option with the given command, after resolving it if a lazy parse is pending, or an option that was never set if there's no such command.
+     */
+    [[nodiscard]] const DArgumentOption &Get(char command);
+
+    /**
+     * @return Returns the option with the given command, after resolving it if a lazy parse is pending, or an option that was never set if there's no such command.
+     */
+    [[nodiscard]] const DArgumentOption &Get(const std::string &command);
+
+    /**
+     * @return Returns the option itself, after resolving it if a lazy parse is pending, or an option that was never set if it isn't part of the parser.
+     */
+    [[nodiscard]] const DArgumentOption &Get(const DArgumentOption &option);
+
     /**
      * Retrieves the value of every positional argument that was set during the parsing.
-     * @return Returns a const reference to the positionalArgsValues list.
+     * @return Returns a const reference to the positionalArgsValues list, the strings are only created on the first call after parsing.
      */
     [[nodiscard]] const std::vector<std::string> &GetPositionalArguments() const;
 
-    [[nodiscard]] std::string VersionText();
+    /**
+     * Retrieves the value of every positional argument that was set during the parsing without copying them.
+     * @return Returns a const reference to a list of views pointing directly into the argv passed on creation.
+     */
+    [[nodiscard]] const std::pmr::vector<std::string_view> &GetPositionalArgumentViews() const;
+
+    /**
+     * @return Returns the long commands an abbreviation could stand for, if the last parse failed with DParseResult::AmbiguousOption, in alphabetical order.
+     */
+    [[nodiscard]] const std::pmr::vector<std::string_view> &GetAmbiguousCandidates() const;
+
+    /**
+     * @return Returns the command line values of the options that keep multiple values (see DArgumentOption::SetMultipleValues) in the order they were passed, for tools where the order across options matters (e.g. "-I a -isystem b -I c").
+     */
+    [[nodiscard]] const std::pmr::vector<DArgumentOccurrence> &GetOccurrences() const;
 
-    [[nodiscard]] std::string HelpText();
+    /**
+     * @return Returns the long commands closest to the one that made the last parse fail with DParseResult::InvalidOption (up to 3, closest first), which ErrorText also suggests. Empty if nothing was close or the parse didn't fail that way.
+     */
+    [[nodiscard]] const std::pmr::vector<std::string_view> &GetSuggestions() const;
+
+    /**
+     * @return Returns a reference to the version text, it's only generated again if the app info changed since the last call.
+     */
+    [[nodiscard]] const std::string &VersionText();
+
+    /**
+     * @return Returns a reference to the help text, it's only generated again if the app info, positional arguments, argument options or any of the added options changed since the last call.
+     */
+    [[nodiscard]] const std::string &HelpText();
+
+    /**
+     * <br>Writes the help text directly into the sink, piece by piece, without building it in memory first.
+     * <br>The order and width of the option lines are computed once and reused until something used by the help text changes.
+     */
+    void WriteHelp(DHelpSink &sink);
+
+    /**
+     * <br>Writes a completion script for the given shell, which completes the executable name by running it with __complete (see WriteCompletions) on every tab press.
+     * <br>Usually printed when requested by an option of the program, e.g. "source <(myapp --completion bash)" or "myapp --completion fish | source".
+     */
+    void WriteCompletionScript(DHelpSink &sink, DCompletionShell shell);
+
+    /**
+     * <br>If the first argument of argv is __complete, writes the completions of the last argument (the word being completed), one per line, with a tab and the description after the commands.
+     * <br>The arguments in between are only read to tell whether the word is the value of an option and which subcommand it belongs to, nothing is parsed and no help text is generated.
+     * <br>Should be called as soon as the options are added, before Parse.
+     * @return true if argv is a completion query (and the program should exit), otherwise false.
+     */
+    bool WriteCompletions(DHelpSink &sink);
 
     [[nodiscard]] std::string ErrorText() const;
 
+    /**
+     * <br>Sets a function called at the end of every parse and help rendering with the statistics of that call alone, replacing the previous one (an empty function removes it).
+     * <br>Only called when the library is built with DARGUMENTPARSER_INSTRUMENTATION.
+     */
+    void SetStatisticsObserver(std::function<void(const DParseStatistics &)> observer);
+
+    /**
+     * @return Returns the statistics added up since the parser was created or ResetStatistics was called, all 0 unless the library is built with DARGUMENTPARSER_INSTRUMENTATION.
+     */
+    [[nodiscard]] const DParseStatistics &GetStatistics() const;
+
+    void ResetStatistics();
+
+    /**
+     * @return Returns a printable description of why the last call to AddArgumentOption failed, naming the command that collided (if that was the reason), or an empty string if it succeeded.
+     */
+    [[nodiscard]] std::string RegistrationErrorText() const;
+
+    /**
+     * @return Returns the printable error text for a parse error that happened with the given long command (or response file path).
+     */
+    [[nodiscard]] static std::string FormatErrorText(DParseResult error, std::string_view command);
+
+    /**
+     * @return Returns the printable error text for a parse error that happened with the given short command.
+     */
+    [[nodiscard]] static std::string FormatErrorText(DParseResult error, char command);
+
     /**
      * <br>Parses the argv passed on creation based on the positional arguments and option arguments added.
+     * <br>No copies of the arguments are made, values and positional arguments are kept as views into argv (or into the response files, which are kept mapped until the next parse), so argv needs to outlive the parser.
      * @return true if parse was successful, false if an error occurred (non-optional parameter not passed). Call "ErrorText" function to retrieve a printable string of the error.
      */
     DParseResult Parse();
+
+    /**
+     * <br>Same as Parse, but the arguments are read from a single command string (without the executable name), split with DCommandTokenizer.
+     * <br>The string is copied into the parser once and split in place, values and positional arguments are views into that copy and stay valid until the next parse.
+     */
+    DParseResult ParseCommandString(std::string_view _commandString);
+
+    /**
+     * <br>Parses argv on demand, for programs that only check a few options: argv is gone through once to record which arguments are commands, and an option is only set from them the first time it's queried through WasSet or Get (the option's own WasSet/GetValue don't trigger it).
+     * <br>The environment is read once, the first time an option with an environment variable is queried.
+     * <br>Options that are never queried keep the values of the previous parse, and positional arguments are only filled in by Validate. Parsers with subcommands are always parsed in full, as if Parse was called.
+     * @return DParseResult::ParseSuccessful, unless a response file couldn't be read. Every other error is only found by Validate, until then the options are set from the valid commands.
+     */
+    DParseResult ParseLazily();
+
+    /**
+     * <br>Finishes the parse started by ParseLazily, parsing every argument like Parse does: all the options are set, the positional arguments are filled in and ErrorText tells what went wrong.
+     * @return Returns what Parse would have returned, calling it again returns the same result.
+     */
+    DParseResult Validate();
+
+    /**
+     * <br>Starts editing the argument list incrementally, beginning with the arguments passed on creation (response files aren't expanded), for interactive shells that validate the command line on every keystroke.
+     * <br>Edits only change the end of the list: each one rolls back the arguments it removes through a per argument journal and parses the ones it adds, so its cost depends on the size of the edit rather than the length of the command line. The entries of the environment and the config file that belong to an option are found once, here, and like Parse they only fill in the options after an edit that leaves the command line valid.
+     * <br>Values and positional arguments are views into the parser's copies of the edited arguments. Any other parse ends the editing, and parsers with subcommands are parsed in full on every edit.
+     * @return Returns what Parse would return for the current argument list, as do all the edits below.
+     */
+    DParseResult BeginArgumentEditing();
+
+    /**
+     * Adds an argument at the end of the edited list (starting the editing if it wasn't started).
+     */
+    DParseResult AppendArgument(std::string_view argument);
+
+    /**
+     * Replaces the last edited argument, or appends it if the list is empty.
+     */
+    DParseResult ReplaceLastArgument(std::string_view argument);
+
+    /**
+     * Removes the edited arguments after the first count ones.
+     */
+    DParseResult TruncateArguments(size_t count);
+
+    /**
+     * Reverts the last append, replace or truncate, restoring the arguments it removed.
+     * @return Returns the result for the argument list after the undo, or the current result if there's nothing to undo.
+     */
+    DParseResult UndoArgumentEdit();
+
+    /**
+     * @return Returns the number of edited arguments, without the executable name.
+     */
+    [[nodiscard]] size_t EditedArgumentCount() const;
+};
+
+/**
+ * The results of parsing a command line with DArgumentSchema::Parse, owned by the caller and independent of any other parse.
+ * <br>Results are read through DArgumentOptions holding the same values a DArgumentOption added to a DArgumentParser would hold after parsing.
+ * @details The schema that created the outcome must outlive it.
+ */
+class DParseOutcome {
+    friend class DArgumentSchema;
+
+    const DArgumentSchema *schema = nullptr;
+    DParseResult result = DParseResult::ParseSuccessful;
+    std::vector<DArgumentOption> options;
+    std::pmr::vector<std::string_view> arguments;
+    std::pmr::vector<DMappedFile> responseFiles;
+    std::pmr::vector<std::string_view> positionalArgsViews;
+    mutable std::vector<std::string> positionalArgsValues;
+    std::pmr::string errorText;
+    std::pmr::vector<std::string_view> ambiguousCandidates;
+
+    explicit DParseOutcome(const DArgumentSchema *_schema);
+
+public:
+    [[nodiscard]] DParseResult Result() const;
+
+    /**
+     * @return Returns the results of the given option, which has to be one of the options the schema was created from, or an option that was never set if it isn't.
+     */
+    [[nodiscard]] const DArgumentOption &Get(const DArgumentOption &option) const;
+
+    /**
+     * @return Returns the results of the option with the given command, or an option that was never set if there's no such command.
+     */
+    [[nodiscard]] const DArgumentOption &Get(char command) const;
+
+    /**
+     * @return Returns the results of the option with the given command, or an option that was never set if there's no such command.
+     */
+    [[nodiscard]] const DArgumentOption &Get(std::string_view command) const;
+
+    [[nodiscard]] int WasSet(const DArgumentOption &option) const;
+
+    [[nodiscard]] int WasSet(char command) const;
+
+    [[nodiscard]] int WasSet(std::string_view command) const;
+
+    /**
+     * @return Returns a const reference to the positional arguments, the strings are only created on the first call.
+     */
+    [[nodiscard]] const std::vector<std::string> &GetPositionalArguments() const;
+
+    [[nodiscard]] const std::pmr::vector<std::string_view> &GetPositionalArgumentViews() const;
+
+    [[nodiscard]] const std::pmr::vector<std::string_view> &GetAmbiguousCandidates() const;
+
+    [[nodiscard]] std::string ErrorText() const;
+};
+
+/**
+ * A value passed to an InputOption of one of the command lines parsed by DArgumentSchema::ParseBatch.
+ * @def option - position of the option in the schema (see DArgumentSchema::IndexOf).
+ * @def value - view into the command line it was read from, for buffers the offset of the value is value.data() minus the start of the buffer.
+ */
+struct DBatchValue {
+    int option;
+    std::string_view value;
+};
+
+/**
+ * Compact results of DArgumentSchema::ParseBatch, for every command line: the DParseResult, a bitmap of the options that were set and the values passed to InputOptions (the last one, if set more than once).
+ */
+class DBatchParseResults {
+    friend class DArgumentSchema;
+
+    size_t bitmapWords = 0;
+    size_t chunkSize = 1;
+    std::vector<DParseResult> results;
+    std::vector<unsigned long long> setOptions;
+    std::vector<unsigned> valuesBegin;
+    std::vector<std::vector<DBatchValue>> chunkValues;
+
+public:
+    /**
+     * @return Returns the number of command lines parsed.
+     */
+    [[nodiscard]] size_t Size() const;
+
+    [[nodiscard]] DParseResult Result(size_t line) const;
+
+    /**
+     * @return Returns whether the option at the given position of the schema was set in the command line, if the parse failed only the options set before the error are marked.
+     */
+    [[nodiscard]] bool WasSet(size_t line, int option) const;
+
+    /**
+     * @return Returns the bitmap of the options set in the command line, BitmapWords() words long, where bit (option % 64) of word (option / 64) belongs to the option at that position of the schema.
+     */
+    [[nodiscard]] const unsigned long long *SetOptions(size_t line) const;
+
+    [[nodiscard]] size_t BitmapWords() const;
+
+    [[nodiscard]] size_t ValueCount(size_t line) const;
+
+    [[nodiscard]] const DBatchValue &Value(size_t line, size_t index) const;
+
+    /**
+     * @return Returns the value passed to the option at the given position of the schema, or an empty view if it wasn't set.
+     */
+    [[nodiscard]] std::string_view GetValue(size_t line, int option) const;
+};
+
+/**
+ * An immutable set of argument options, parsing with it doesn't change any shared state so the same schema can be used by many threads at once, without locking.
+ * <br>Created from a list of options or with DArgumentParser::CreateSchema, the options are copied so they can be changed or destroyed afterwards.
+ */
+class DArgumentSchema {
+    friend class DParseOutcome;
+
+    class OutcomeCommandIndex;
+
+    class BatchCommandIndex;
+
+    std::vector<DArgumentOption> options;
+    std::unordered_map<const DArgumentOption *, int> sourceIndex;
+    std::array<int, 256> shortCommandIndex{};
+    std::unordered_map<std::string_view, int> longCommandIndex;
+    std::unordered_map<std::string_view, int> environmentIndex;
+    std::pmr::vector<std::string_view> sortedLongCommands;
+    bool expandResponseFiles;
+    bool allowAbbreviations;
+    bool valid = true;
+
+    int findOption(char command) const;
+
+    int findOption(std::string_view command) const;
+
+    /**
+     * Parses lineCount command lines in chunks spread over the threads, lineArguments(line, arguments) fills in the arguments of a line.
+     */
+    template<typename LineArguments>
+    DBatchParseResults parseBatch(size_t lineCount, const LineArguments &lineArguments, unsigned threadCount) const;
+
+public:
+    /**
+     * <br>Options are checked with the same rules as DArgumentParser::AddArgumentOption, invalid options are left out of the schema (see IsValid).
+     * @param _options the options to copy, the pointers are only used to find the results of an option in a DParseOutcome later on.
+     * @param _expandResponseFiles same as DArgumentParser::SetResponseFileExpansion.
+     * @param _allowAbbreviations same as DArgumentParser::SetLongCommandAbbreviation.
+     */
+    explicit DArgumentSchema(const std::vector<const DArgumentOption *> &_options, bool _expandResponseFiles = false, bool _allowAbbreviations = false);
+
+    DArgumentSchema(const DArgumentSchema &) = delete;
+
+    DArgumentSchema &operator=(const DArgumentSchema &) = delete;
+
+    DArgumentSchema(DArgumentSchema &&) = default;
+
+    DArgumentSchema &operator=(DArgumentSchema &&) = default;
+
+    /**
+     * @return false if any of the options passed on creation was invalid(1) and left out.
+     * @def invalid(1) - has no commands, was passed more than once or has a command already used by an option before it.
+     */
+    [[nodiscard]] bool IsValid() const;
+
+    [[nodiscard]] size_t OptionCount() const;
+
+    /**
+     * @return Returns the position of the option in the schema, or -1 if it isn't part of it.
+     */
+    [[nodiscard]] int IndexOf(const DArgumentOption &option) const;
+
+    /**
+     * <br>Parses argv the same way DArgumentParser::Parse does (reading environ for the options with an environment variable), writing the results into a new DParseOutcome.
+     * <br>Thread safe, argv needs to outlive the returned outcome.
+     */
+    [[nodiscard]] DParseOutcome Parse(int argc, char **argv) const;
+
+    /**
+     * <br>Parses every command line of the list (each one an argv, starting with the executable) across threadCount threads, without creating a DParseOutcome for each of them.
+     * <br>Response files are never expanded and environment variables aren't read. The command lines need to outlive the returned results.
+     * @param threadCount number of threads to use, 0 to use one per hardware thread.
+     */
+    [[nodiscard]] DBatchParseResults ParseBatch(const std::vector<std::vector<std::string_view>> &commandLines, unsigned threadCount = 0) const;
+
+    /**
+     * <br>Same as above, but the command lines are read from a buffer, separated by lineDelimiter (new line or NUL), with their arguments separated by whitespaces.
+     * <br>Like the command lines above, the first argument of every line is the executable and isn't parsed, so "app -v" sets -v while a line of just "-v" sets nothing.
+     * <br>Quotes and backslashes have no special meaning here, so every argument and value is a plain slice of the buffer. A delimiter at the end of the buffer doesn't start a new command line.
+     */
+    [[nodiscard]] DBatchParseResults ParseBatch(std::string_view buffer, char lineDelimiter = '\n', unsigned threadCount = 0) const;
+};
+
+/**
+ * Parses argv straight from a schema image created by DArgumentParser::CreateSchemaImage, either mapped from a file or embedded into the program, so no option is built or checked at startup.
+ * <br>Lookups go through the sorted tables of the image, only the options found while parsing get a DArgumentOption holding their results.
+ */
+class DMappedArgumentParser {
+    class ImageCommandIndex;
+
+    int argumentCount;
+    char **argumentValues;
+    DMappedFile file;
+    std::string_view image;
+    unsigned optionCount = 0;
+    unsigned longCommandCount = 0;
+    unsigned environmentCount = 0;
+    bool expandResponseFiles = false;
+    bool allowAbbreviations = false;
+    std::vector<int> optionSlots;
+    std::vector<DArgumentOption> foundOptions;
+    std::vector<int> foundOptionIndexes;
+    std::pmr::vector<std::string_view> sortedLongCommands;
+    std::pmr::vector<std::string_view> arguments;
+    std::pmr::vector<DMappedFile> responseFiles;
+    std::pmr::vector<std::string_view> positionalArgsViews;
+    std::pmr::string errorText;
+    std::pmr::vector<std::string_view> ambiguousCandidates;
+
+    [[nodiscard]] unsigned word(size_t offset) const;
+
+    /**
+     * @return Returns the string of the string section referenced by the offset and size words at the given offset of the image.
+     */
+    [[nodiscard]] std::string_view imageString(size_t offset) const;
+
+    /**
+     * @return Returns the position of the entry of the sorted table whose string is the key, or -1 if there's none.
+     */
+    [[nodiscard]] int findEntry(size_t tableOffset, unsigned entryCount, std::string_view key) const;
+
+    [[nodiscard]] int findOption(char command) const;
+
+    [[nodiscard]] int findOption(std::string_view command) const;
+
+    [[nodiscard]] int findEnvironmentVariable(std::string_view name) const;
+
+    /**
+     * Checks every table of the image against its bounds, only then the image is used.
+     */
+    bool load(std::string_view _image);
+
+    void resetParsedValues();
+
+public:
+    DMappedArgumentParser(int argc, char **argv);
+
+    /**
+     * Maps the schema image at the given path, replacing the one loaded before.
+     * @return false if the file couldn't be read or isn't a valid schema image, in which case there are no options.
+     */
+    bool Open(const std::string &path);
+
+    /**
+     * Loads a schema image from memory (e.g. an array embedded into the program), replacing the one loaded before. The memory isn't copied, so it needs to outlive the parser.
+     * @return false if it isn't a valid schema image, in which case there are no options.
+     */
+    bool Load(std::string_view _image);
+
+    [[nodiscard]] bool IsValid() const;
+
+    [[nodiscard]] size_t OptionCount() const;
+
+    /**
+     * <br>Parses argv the same way DArgumentParser::Parse does (reading environ for the options with an environment variable), config files and subcommands aren't part of schema images.
+     * <br>Values and positional arguments are views into argv, or into the response files, which are kept mapped until the next parse.
+     */
+    DParseResult Parse();
+
+    [[nodiscard]] int WasSet(char command) const;
+
+    [[nodiscard]] int WasSet(std::string_view command) const;
+
+    /**
+     * @return Returns the results of the option with the given command, or an option that was never set if it wasn't found by the last parse.
+     */
+    [[nodiscard]] const DArgumentOption &Get(char command) const;
+
+    /**
+     * @return Returns the results of the option with the given command, or an option that was never set if it wasn't found by the last parse.
+     */
+    [[nodiscard]] const DArgumentOption &Get(std::string_view command) const;
+
+    [[nodiscard]] const std::pmr::vector<std::string_view> &GetPositionalArgumentViews() const;
+
+    [[nodiscard]] const std::pmr::vector<std::string_view> &GetAmbiguousCandidates() const;
+
+    /**
+     * @return Returns the help text rendered when the image was created, pointing into the image.
+     */
+    [[nodiscard]] std::string_view HelpText() const;
+
+    [[nodiscard]] std::string_view VersionText() const;
+
+    [[nodiscard]] std::string ErrorText() const;
 };
 
 #endif //DARGUMENTPARSER_LIBRARY_H
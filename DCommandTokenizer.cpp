@@ -0,0 +1,182 @@
+#include "DCommandTokenizer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+const char singleQuote = '\'', doubleQuote = '"', backslash = '\\';
+const int blockSize = 64;
+
+//same characters as std::isspace in the "C" locale
+static bool isWhitespace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static bool isQuoteOrBackslash(char c) {
+    return c == singleQuote || c == doubleQuote || c == backslash;
+}
+
+/**
+ * Bitmaps of a block of 64 bytes, bit i belongs to byte i of the block.
+ */
+struct BlockMasks {
+    unsigned long long whitespaces = 0;
+    unsigned long long quotesAndBackslashes = 0;
+};
+
+static BlockMasks masksOfBlock(const char *block) {
+    BlockMasks masks;
+#if defined(__AVX2__)
+    const __m256i spaces = _mm256_set1_epi8(' '), singleQuotes = _mm256_set1_epi8(singleQuote), doubleQuotes = _mm256_set1_epi8(doubleQuote), backslashes = _mm256_set1_epi8(backslash);
+    const __m256i beforeTab = _mm256_set1_epi8('\t' - 1), afterCarriageReturn = _mm256_set1_epi8('\r' + 1);
+    for (int offset = 0; offset < blockSize; offset += 32) {
+        __m256i bytes = _mm256_loadu_si256((const __m256i *) (block + offset));
+        __m256i whitespaces = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, spaces), _mm256_and_si256(_mm256_cmpgt_epi8(bytes, beforeTab), _mm256_cmpgt_epi8(afterCarriageReturn, bytes)));
+        __m256i quotesAndBackslashes = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, singleQuotes), _mm256_cmpeq_epi8(bytes, doubleQuotes)), _mm256_cmpeq_epi8(bytes, backslashes));
+        masks.whitespaces |= (unsigned long long) (unsigned) _mm256_movemask_epi8(whitespaces) << offset;
+        masks.quotesAndBackslashes |= (unsigned long long) (unsigned) _mm256_movemask_epi8(quotesAndBackslashes) << offset;
+    }
+#elif defined(__SSE2__)
+    const __m128i spaces = _mm_set1_epi8(' '), singleQuotes = _mm_set1_epi8(singleQuote), doubleQuotes = _mm_set1_epi8(doubleQuote), backslashes = _mm_set1_epi8(backslash);
+    const __m128i beforeTab = _mm_set1_epi8('\t' - 1), afterCarriageReturn = _mm_set1_epi8('\r' + 1);
+    for (int offset = 0; offset < blockSize; offset += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *) (block + offset));
+        __m128i whitespaces = _mm_or_si128(_mm_cmpeq_epi8(bytes, spaces), _mm_and_si128(_mm_cmpgt_epi8(bytes, beforeTab), _mm_cmplt_epi8(bytes, afterCarriageReturn)));
+        __m128i quotesAndBackslashes = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, singleQuotes), _mm_cmpeq_epi8(bytes, doubleQuotes)), _mm_cmpeq_epi8(bytes, backslashes));
+        masks.whitespaces |= (unsigned long long) (unsigned) _mm_movemask_epi8(whitespaces) << offset;
+        masks.quotesAndBackslashes |= (unsigned long long) (unsigned) _mm_movemask_epi8(quotesAndBackslashes) << offset;
+    }
+#else
+    for (int index = 0; index < blockSize; index++) {
+        if (isWhitespace(block[index]))
+            masks.whitespaces |= 1ULL << index;
+        else if (isQuoteOrBackslash(block[index]))
+            masks.quotesAndBackslashes |= 1ULL << index;
+    }
+#endif
+    return masks;
+}
+
+static int countTrailingZeros(unsigned long long mask) {
+    return __builtin_ctzll(mask);
+}
+
+/**
+ * @return Returns the first byte of the range matching the predicate, or end if there's none.
+ */
+template<typename Predicate>
+static char *findFirst(char *position, char *end, Predicate predicate) {
+    //runs inside arguments are usually short, so the first bytes are checked one by one before going through whole blocks
+    for (char *shortRunEnd = position + std::min<long>(end - position, 16); position != shortRunEnd; ++position)
+        if (predicate(BlockMasks{isWhitespace(*position), isQuoteOrBackslash(*position)}) != 0)
+            return position;
+    for (; end - position >= blockSize; position += blockSize) {
+        BlockMasks masks = masksOfBlock(position);
+        unsigned long long mask = predicate(masks);
+        if (mask != 0)
+            return position + countTrailingZeros(mask);
+    }
+    while (position != end && predicate(BlockMasks{isWhitespace(*position), isQuoteOrBackslash(*position)}) == 0)
+        ++position;
+    return position;
+}
+
+static unsigned long long unquotedSpecial(const BlockMasks &masks) {
+    return masks.whitespaces | masks.quotesAndBackslashes;
+}
+
+/**
+ * Moves the plain characters in [read, runEnd) to write, unless nothing was removed so far and they're already in place.
+ */
+static void moveRun(char *&read, char *runEnd, char *&write) {
+    size_t size = runEnd - read;
+    if (write != read)
+        std::memmove(write, read, size);
+    write += size;
+    read = runEnd;
+}
+
+/**
+ * Reads a single argument starting at read, handling quotes and escape characters, and stops at the whitespace after it (or at end).
+ */
+static void tokenizeArgument(char *&read, char *end, char *&write) {
+    while (read != end) {
+        moveRun(read, findFirst(read, end, unquotedSpecial), write);
+        if (read == end || isWhitespace(*read))
+            return;
+        char c = *read++;
+        if (c == backslash) {
+            if (read != end)
+                c = *read++;
+            *write++ = c;
+            continue;
+        }
+        if (c == singleQuote) {
+            auto quoteEnd = (char *) std::memchr(read, singleQuote, end - read);
+            moveRun(read, quoteEnd == nullptr ? end : quoteEnd, write);
+            if (read != end)
+                ++read;
+            continue;
+        }
+        while (read != end) {
+            auto quoteOrBackslash = findFirst(read, end, [](const BlockMasks &masks) { return masks.quotesAndBackslashes; });
+            //the mask also matches single quotes, which are plain characters inside double quotes
+            moveRun(read, quoteOrBackslash, write);
+            if (read == end)
+                break;
+            c = *read++;
+            if (c == doubleQuote)
+                break;
+            if (c == singleQuote)
+                *write++ = c;
+            else if (read != end)
+                *write++ = *read++;
+            else
+                *write++ = backslash;
+        }
+    }
+}
+
+void DCommandTokenizer::TokenizeInPlace(char *begin, char *end, std::pmr::vector<std::string_view> &arguments) {
+    char *read = begin, *write = begin;
+    while (read != end) {
+        //the bytes of the block before its first quote or backslash are split with the whitespace bitmap alone, each argument starts at a whitespace to non-whitespace transition and ends at the opposite one
+        if (end - read >= blockSize) {
+            BlockMasks masks = masksOfBlock(read);
+            int plainSize = masks.quotesAndBackslashes == 0 ? blockSize : countTrailingZeros(masks.quotesAndBackslashes);
+            unsigned long long plainBytes = plainSize == blockSize ? ~0ULL : (1ULL << plainSize) - 1;
+            unsigned long long nonWhitespaces = ~masks.whitespaces;
+            //read is never in the middle of an argument here, so the bit before the block counts as a whitespace
+            unsigned long long starts = nonWhitespaces & ~(nonWhitespaces << 1) & plainBytes;
+            unsigned long long ends = masks.whitespaces & (nonWhitespaces << 1) & plainBytes;
+            //the argument that goes past the plain bytes (if any) is left for tokenizeArgument, only the bytes before it are moved so it's still intact at read
+            int remainingStart = __builtin_popcountll(starts) > __builtin_popcountll(ends) ? 63 - __builtin_clzll(starts) : plainSize;
+            if (write != read)
+                std::memmove(write, read, remainingStart);
+            for (; ends != 0; ends &= ends - 1, starts &= starts - 1) {
+                int start = countTrailingZeros(starts);
+                arguments.emplace_back(write + start, countTrailingZeros(ends) - start);
+            }
+            read += remainingStart;
+            write += remainingStart;
+            if (remainingStart == blockSize)
+                continue;
+            char *argumentStart = write;
+            tokenizeArgument(read, end, write);
+            arguments.emplace_back(argumentStart, write - argumentStart);
+            continue;
+        }
+        while (read != end && isWhitespace(*read))
+            ++read;
+        if (read == end)
+            break;
+        char *argumentStart = write;
+        tokenizeArgument(read, end, write);
+        arguments.emplace_back(argumentStart, write - argumentStart);
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef DARGUMENTPARSER_DCOMMANDTOKENIZER_H
+#define DARGUMENTPARSER_DCOMMANDTOKENIZER_H
+
+#include <string_view>
+#include <memory_resource>
+#include <vector>
+
+/**
+ * Splits command strings into arguments, the way a shell would.
+ * <br>Arguments are separated by whitespaces, single and double quotes can be used to keep whitespaces and a backslash escapes the next character (except inside single quotes).
+ * <br>The bytes that need special handling (whitespaces, quotes and backslashes) are searched 32 or 16 at a time when built with AVX2 or SSE2, with a scalar fallback for other targets.
+ */
+class DCommandTokenizer {
+public:
+    /**
+     * <br>Splits the buffer, removing quotes and escape characters in place, and appends a view of each argument to the list.
+     * <br>Because an unquoted argument is never larger than its quoted form, the buffer is rewritten from the start while it's being read, so no copies are made. The buffer needs to outlive the views.
+     */
+    static void TokenizeInPlace(char *begin, char *end, std::pmr::vector<std::string_view> &arguments);
+};
+
+#endif //DARGUMENTPARSER_DCOMMANDTOKENIZER_H
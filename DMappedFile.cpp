@@ -0,0 +1,81 @@
+#include "DMappedFile.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static long long modificationTimeOf(const struct stat &fileStat) {
+    return (long long) fileStat.st_mtim.tv_sec * 1000000000LL + fileStat.st_mtim.tv_nsec;
+}
+
+DMappedFile::DMappedFile(DMappedFile &&other) noexcept : data(other.data), size(other.size), modificationTime(other.modificationTime) {
+    other.data = nullptr;
+    other.size = 0;
+    other.modificationTime = 0;
+}
+
+DMappedFile &DMappedFile::operator=(DMappedFile &&other) noexcept {
+    if (this == &other)
+        return *this;
+    Close();
+    data = other.data;
+    size = other.size;
+    modificationTime = other.modificationTime;
+    other.data = nullptr;
+    other.size = 0;
+    other.modificationTime = 0;
+    return *this;
+}
+
+DMappedFile::~DMappedFile() {
+    Close();
+}
+
+bool DMappedFile::Open(const char *path) {
+    Close();
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    struct stat fileStat{};
+    if (fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode)) {
+        close(fd);
+        return false;
+    }
+    if (fileStat.st_size == 0) {
+        close(fd);
+        modificationTime = modificationTimeOf(fileStat);
+        return true;
+    }
+    void *mapped = mmap(nullptr, (size_t) fileStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+        return false;
+    data = static_cast<char *>(mapped);
+    size = (size_t) fileStat.st_size;
+    modificationTime = modificationTimeOf(fileStat);
+    return true;
+}
+
+void DMappedFile::Close() {
+    if (data != nullptr)
+        munmap(data, size);
+    data = nullptr;
+    size = 0;
+    modificationTime = 0;
+}
+
+bool DMappedFile::IsUnchanged(const char *path) const {
+    struct stat fileStat{};
+    if (modificationTime == 0 || stat(path, &fileStat) != 0)
+        return false;
+    return (size_t) fileStat.st_size == size && modificationTimeOf(fileStat) == modificationTime;
+}
+
+char *DMappedFile::Data() const {
+    return data;
+}
+
+size_t DMappedFile::Size() const {
+    return size;
+}
@@ -0,0 +1,49 @@
+#ifndef DARGUMENTPARSER_DMAPPEDFILE_H
+#define DARGUMENTPARSER_DMAPPEDFILE_H
+
+#include <string>
+#include <cstddef>
+
+/**
+ * A file mapped into memory.
+ * <br>The mapping is private (copy-on-write), so the contents can be rewritten in place without the changes ever reaching the file itself.
+ */
+class DMappedFile {
+    char *data = nullptr;
+    size_t size = 0;
+    long long modificationTime = 0;
+
+public:
+    DMappedFile() = default;
+
+    DMappedFile(const DMappedFile &) = delete;
+
+    DMappedFile &operator=(const DMappedFile &) = delete;
+
+    DMappedFile(DMappedFile &&other) noexcept;
+
+    DMappedFile &operator=(DMappedFile &&other) noexcept;
+
+    ~DMappedFile();
+
+    /**
+     * Maps the file at the given path, closing any file previously mapped by this object.
+     * @return true if the file was mapped (empty files are considered mapped, with a size of 0), false if it couldn't be opened.
+     */
+    bool Open(const char *path);
+
+    bool Open(const std::string &path) { return Open(path.c_str()); }
+
+    void Close();
+
+    /**
+     * @return true if the file at the given path has the same size and modification time the mapped file had when it was opened, false otherwise (or if nothing is mapped).
+     */
+    [[nodiscard]] bool IsUnchanged(const char *path) const;
+
+    [[nodiscard]] char *Data() const;
+
+    [[nodiscard]] size_t Size() const;
+};
+
+#endif //DARGUMENTPARSER_DMAPPEDFILE_H
@@ -0,0 +1,341 @@
+#ifndef DARGUMENTPARSER_DSTATICARGUMENTPARSER_H
+#define DARGUMENTPARSER_DSTATICARGUMENTPARSER_H
+
+#include <array>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "DArgumentParser.h"
+
+/**
+ * Default values for the options passed to DStaticArgumentParser, derive from it and hide the members that need to change:
+ * <br>struct OutputOption : DStaticOption {
+ * <br>    static constexpr DArgumentOptionType type = DArgumentOptionType::InputOption;
+ * <br>    static constexpr std::string_view shortCommands = "o";
+ * <br>    static constexpr std::string_view longCommands[] = {"out", "output"};
+ * <br>};
+ * @details shortCommands holds one command per character, longCommands can be any constexpr array of std::string_view.
+ */
+struct DStaticOption {
+    static constexpr DArgumentOptionType type = DArgumentOptionType::NormalOption;
+    static constexpr std::string_view shortCommands{};
+    static constexpr std::array<std::string_view, 0> longCommands{};
+    static constexpr std::string_view description{};
+};
+
+namespace DStaticArgumentParserInternal {
+    struct OptionInfo {
+        DArgumentOptionType type;
+        std::string_view shortCommands;
+        const std::string_view *longCommands;
+        size_t longCommandsSize;
+    };
+
+    struct LongCommandEntry {
+        std::string_view command;
+        int option = -1;
+    };
+
+    template<typename Option>
+    constexpr OptionInfo makeOptionInfo() {
+        return {Option::type, Option::shortCommands, std::data(Option::longCommands), std::size(Option::longCommands)};
+    }
+
+    constexpr unsigned hashCommand(std::string_view command) {
+        unsigned hash = 2166136261u;
+        for (char c: command) {
+            hash ^= (unsigned char) c;
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    constexpr size_t longCommandTableSize(size_t longCommandCount) {
+        size_t size = 2;
+        while (size < longCommandCount * 2)
+            size *= 2;
+        return size;
+    }
+
+    //same rules as DArgumentOption::AddShortCommand
+    constexpr bool isValidShortCommand(char shortCommand) {
+        return !(shortCommand < 33 || shortCommand == '-' || shortCommand == 127);
+    }
+
+    //same rules as DArgumentOption::AddLongCommand
+    constexpr bool isValidLongCommand(std::string_view longCommand) {
+        return !longCommand.empty() && longCommand.front() != '-' && longCommand.find('=') == std::string_view::npos;
+    }
+
+    template<size_t N>
+    constexpr bool allOptionsHaveCommands(const std::array<OptionInfo, N> &options) {
+        for (const auto &option: options)
+            if (option.shortCommands.empty() && option.longCommandsSize == 0)
+                return false;
+        return true;
+    }
+
+    template<size_t N>
+    constexpr bool allCommandsAreValid(const std::array<OptionInfo, N> &options) {
+        for (const auto &option: options) {
+            for (char shortCommand: option.shortCommands)
+                if (!isValidShortCommand(shortCommand))
+                    return false;
+            for (size_t i = 0; i < option.longCommandsSize; i++)
+                if (!isValidLongCommand(option.longCommands[i]))
+                    return false;
+        }
+        return true;
+    }
+
+    template<size_t N>
+    constexpr std::array<int, 256> buildShortCommandTable(const std::array<OptionInfo, N> &options) {
+        std::array<int, 256> table{};
+        for (auto &entry: table)
+            entry = -1;
+        for (size_t i = 0; i < N; i++)
+            for (char shortCommand: options[i].shortCommands)
+                table[(unsigned char) shortCommand] = (int) i;
+        return table;
+    }
+
+    template<size_t N>
+    constexpr bool shortCommandsAreUnique(const std::array<OptionInfo, N> &options) {
+        std::array<int, 256> owners{};
+        for (auto &owner: owners)
+            owner = -1;
+        for (size_t i = 0; i < N; i++)
+            for (char shortCommand: options[i].shortCommands) {
+                int &owner = owners[(unsigned char) shortCommand];
+                if (owner != -1 && owner != (int) i)
+                    return false;
+                owner = (int) i;
+            }
+        return true;
+    }
+
+    /**
+     * Open addressing table with linear probing, the size is always a power of 2 with at most half of it filled.
+     * @return false in the second member if a long command is used by more than one option.
+     */
+    template<size_t TableSize, size_t N>
+    constexpr std::pair<std::array<LongCommandEntry, TableSize>, bool> buildLongCommandTable(const std::array<OptionInfo, N> &options) {
+        std::array<LongCommandEntry, TableSize> table{};
+        bool unique = true;
+        for (size_t i = 0; i < N; i++)
+            for (size_t j = 0; j < options[i].longCommandsSize; j++) {
+                std::string_view command = options[i].longCommands[j];
+                size_t slot = hashCommand(command) & (TableSize - 1);
+                while (table[slot].option != -1 && table[slot].command != command)
+                    slot = (slot + 1) & (TableSize - 1);
+                if (table[slot].option != -1 && table[slot].option != (int) i)
+                    unique = false;
+                table[slot] = {command, (int) i};
+            }
+        return {table, unique};
+    }
+
+    template<typename Option, typename... Options>
+    constexpr int indexOf() {
+        constexpr bool matches[] = {std::is_same_v<Option, Options>...};
+        for (size_t i = 0; i < sizeof...(Options); i++)
+            if (matches[i])
+                return (int) i;
+        return -1;
+    }
+}
+
+/**
+ * <br>Argument parser for a set of options known at compile time.
+ * <br>The options are validated (same rules as DArgumentOption and DArgumentParser::AddArgumentOption) and their lookup tables are generated at compile time, so constructing the parser costs nothing.
+ * <br>Parse results follow the same rules as DArgumentParser::Parse, response files are not supported.
+ * @tparam Options types derived from DStaticOption, each one describing an option.
+ */
+template<typename... Options>
+class DStaticArgumentParser {
+    static constexpr size_t optionCount = sizeof...(Options);
+    static constexpr std::array<DStaticArgumentParserInternal::OptionInfo, optionCount> options = {DStaticArgumentParserInternal::makeOptionInfo<Options>()...};
+    static constexpr size_t longCommandCount = (std::size(Options::longCommands) + ... + 0);
+    static constexpr size_t longTableSize = DStaticArgumentParserInternal::longCommandTableSize(longCommandCount);
+    static constexpr auto longCommandTable = DStaticArgumentParserInternal::buildLongCommandTable<longTableSize>(options);
+    static constexpr std::array<int, 256> shortCommandTable = DStaticArgumentParserInternal::buildShortCommandTable(options);
+
+    static_assert(DStaticArgumentParserInternal::allOptionsHaveCommands(options), "every option needs at least one command, either long or short");
+    static_assert(DStaticArgumentParserInternal::allCommandsAreValid(options), "short commands can't be spaces, non printable characters or the minus(-) sign, and long commands can't be empty, start with a minus(-) sign or have an equal(=) sign");
+    static_assert(DStaticArgumentParserInternal::shortCommandsAreUnique(options), "a short command is used by more than one option");
+    static_assert(longCommandTable.second, "a long command is used by more than one option");
+
+    int argumentCount;
+    char **argumentValues;
+    std::array<int, optionCount> wasSet{};
+    std::array<std::string_view, optionCount> values{};
+    std::vector<std::string_view> positionalArgsValues;
+    DParseResult lastError = DParseResult::ParseSuccessful;
+    std::string_view errorLongCommand;
+    char errorShortCommand = '\0';
+    bool errorWithShortCommand = false;
+
+    static int findLongCommand(std::string_view command) {
+        size_t slot = DStaticArgumentParserInternal::hashCommand(command) & (longTableSize - 1);
+        while (longCommandTable.first[slot].option != -1) {
+            if (longCommandTable.first[slot].command == command)
+                return longCommandTable.first[slot].option;
+            slot = (slot + 1) & (longTableSize - 1);
+        }
+        return -1;
+    }
+
+    static bool isLongCommand(std::string_view argument) {
+        return argument.size() > 2 && argument[0] == '-' && argument[1] == '-';
+    }
+
+    static bool isShortCommand(std::string_view argument) {
+        return argument.size() > 1 && argument[0] == '-' && argument[1] != '-';
+    }
+
+    DParseResult fail(DParseResult error, std::string_view command) {
+        lastError = error;
+        errorLongCommand = command;
+        errorWithShortCommand = false;
+        return error;
+    }
+
+    DParseResult fail(DParseResult error, char command) {
+        lastError = error;
+        errorShortCommand = command;
+        errorWithShortCommand = true;
+        return error;
+    }
+
+    DParseResult parseLongCommand(std::string_view argument, int &currentIndex) {
+        size_t posOfEqualSign = argument.find('=', 2);
+        std::string_view command = argument.substr(2, posOfEqualSign - 2);
+        int option = findLongCommand(command);
+        if (option == -1)
+            return fail(DParseResult::InvalidOption, command);
+        bool takesValue = options[option].type == DArgumentOptionType::InputOption;
+        if (!takesValue && posOfEqualSign != std::string_view::npos)
+            return fail(DParseResult::ValuePassedToOptionThatDoesNotTakeValue, command);
+        if (takesValue) {
+            if (posOfEqualSign == std::string_view::npos) {
+                if (++currentIndex == argumentCount)
+                    return fail(DParseResult::NoValueWasPassedToOption, command);
+                std::string_view value(argumentValues[currentIndex]);
+                if (isLongCommand(value) || isShortCommand(value))
+                    return fail(DParseResult::NoValueWasPassedToOption, command);
+                values[option] = value;
+            } else {
+                if (argument.back() == '=')
+                    return fail(DParseResult::NoValueWasPassedToOption, command);
+                values[option] = argument.substr(posOfEqualSign + 1);
+            }
+        }
+        wasSet[option]++;
+        return DParseResult::ParseSuccessful;
+    }
+
+    DParseResult parseShortCommand(std::string_view argument, int &currentIndex) {
+        for (size_t i = 1; i < argument.size(); i++) {
+            int option = shortCommandTable[(unsigned char) argument[i]];
+            if (option == -1)
+                return fail(DParseResult::InvalidOption, argument[i]);
+            if (options[option].type == DArgumentOptionType::InputOption) {
+                if (argument.size() > 2)
+                    return fail(DParseResult::OptionsThatTakesValueNeedsToBeSetSeparately, argument[i]);
+                if (++currentIndex == argumentCount)
+                    return fail(DParseResult::NoValueWasPassedToOption, argument[i]);
+                std::string_view value(argumentValues[currentIndex]);
+                if (isLongCommand(value) || isShortCommand(value))
+                    return fail(DParseResult::NoValueWasPassedToOption, argument[i]);
+                values[option] = value;
+            }
+            wasSet[option]++;
+        }
+        return DParseResult::ParseSuccessful;
+    }
+
+public:
+    DStaticArgumentParser(int argc, char **argv) : argumentCount(argc), argumentValues(argv) {}
+
+    /**
+     * <br>Parses the argv passed on creation, values and positional arguments are kept as views into it.
+     * @return DParseResult::ParseSuccessful if parse was successful, otherwise the error that occurred. Call "ErrorText" function to retrieve a printable string of the error.
+     */
+    DParseResult Parse() {
+        wasSet.fill(0);
+        values.fill({});
+        positionalArgsValues.clear();
+        lastError = DParseResult::ParseSuccessful;
+        for (int index = 1; index < argumentCount; index++) {
+            std::string_view currArg(argumentValues[index]);
+            DParseResult parseResult;
+            if (isLongCommand(currArg))
+                parseResult = parseLongCommand(currArg, index);
+            else if (isShortCommand(currArg))
+                parseResult = parseShortCommand(currArg, index);
+            else {
+                positionalArgsValues.push_back(currArg);
+                continue;
+            }
+            if (parseResult != DParseResult::ParseSuccessful)
+                return parseResult;
+        }
+        return DParseResult::ParseSuccessful;
+    }
+
+    /**
+     * @return Returns how many times the option was set.
+     */
+    template<typename Option>
+    [[nodiscard]] int WasSet() const {
+        constexpr int index = DStaticArgumentParserInternal::indexOf<Option, Options...>();
+        static_assert(index != -1, "the option is not part of this parser");
+        return wasSet[index];
+    }
+
+    /**
+     * @return Returns how many times the option with the given short command was set, always returns 0 if no option has that command.
+     */
+    [[nodiscard]] int WasSet(char command) const {
+        int option = shortCommandTable[(unsigned char) command];
+        return option == -1 ? 0 : wasSet[option];
+    }
+
+    /**
+     * @return Returns how many times the option with the given long command was set, always returns 0 if no option has that command.
+     */
+    [[nodiscard]] int WasSet(std::string_view command) const {
+        int option = findLongCommand(command);
+        return option == -1 ? 0 : wasSet[option];
+    }
+
+    /**
+     * @return Returns a view of the last value passed to the option, pointing directly into argv.
+     */
+    template<typename Option>
+    [[nodiscard]] std::string_view GetValue() const {
+        constexpr int index = DStaticArgumentParserInternal::indexOf<Option, Options...>();
+        static_assert(index != -1, "the option is not part of this parser");
+        return values[index];
+    }
+
+    [[nodiscard]] const std::vector<std::string_view> &GetPositionalArguments() const {
+        return positionalArgsValues;
+    }
+
+    /**
+     * @return Returns the same printable error text DArgumentParser would generate for the last error, or an empty string if the last parse was successful.
+     */
+    [[nodiscard]] std::string ErrorText() const {
+        if (lastError == DParseResult::ParseSuccessful)
+            return {};
+        if (errorWithShortCommand)
+            return DArgumentParser::FormatErrorText(lastError, errorShortCommand);
+        return DArgumentParser::FormatErrorText(lastError, errorLongCommand);
+    }
+};
+
+#endif //DARGUMENTPARSER_DSTATICARGUMENTPARSER_H
@@ -0,0 +1,2033 @@
+#include "DArgumentParser.h"
+#include "DStaticArgumentParser.h"
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <memory_resource>
+#include <new>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/* ------ allocation counting ------ */
+static std::atomic<size_t> allocationCount{0};
+
+void *operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+//std::stable_sort gets its temporary buffer through the nothrow overloads
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &tag) noexcept {
+    return operator new(size, tag);
+}
+
+//kept out of line, otherwise GCC sees the free inlined next to operator new and warns about a mismatched deallocation
+[[gnu::noinline]] static void releaseAllocation(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr) noexcept {
+    releaseAllocation(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    releaseAllocation(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    releaseAllocation(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    releaseAllocation(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+    releaseAllocation(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+    releaseAllocation(ptr);
+}
+
+//std::pmr::new_delete_resource allocates through the aligned overloads
+void *operator new(size_t size, std::align_val_t alignment) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void *ptr = nullptr;
+    if (posix_memalign(&ptr, std::max(sizeof(void *), (size_t) alignment), size == 0 ? 1 : size) == 0)
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void *operator new(size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void *ptr = nullptr;
+    return posix_memalign(&ptr, std::max(sizeof(void *), (size_t) alignment), size == 0 ? 1 : size) == 0 ? ptr : nullptr;
+}
+
+void *operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t &tag) noexcept {
+    return operator new(size, alignment, tag);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept {
+    releaseAllocation(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept {
+    releaseAllocation(ptr);
+}
+
+void operator delete(void *ptr, size_t, std::align_val_t) noexcept {
+    releaseAllocation(ptr);
+}
+
+void operator delete[](void *ptr, size_t, std::align_val_t) noexcept {
+    releaseAllocation(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+    releaseAllocation(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+    releaseAllocation(ptr);
+}
+
+/* ------ synthetic workloads ------ */
+const char shortCommandCharacters[] = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+const int shortCommandCharactersSize = sizeof(shortCommandCharacters) - 1;
+
+struct SyntheticSchema {
+    std::vector<DArgumentOption *> options;
+    std::vector<std::string> longCommands;
+    std::vector<char> shortCommands; //'\0' when the option has no short command
+
+    explicit SyntheticSchema(int optionCount) {
+        options.reserve(optionCount);
+        longCommands.reserve(optionCount);
+        shortCommands.reserve(optionCount);
+        for (int i = 0; i < optionCount; i++) {
+            auto option = new DArgumentOption(isInputOption(i) ? DArgumentOptionType::InputOption : DArgumentOptionType::NormalOption, "Synthetic option number " + std::to_string(i) + ".");
+            longCommands.emplace_back("option-" + std::to_string(i));
+            option->AddLongCommand(longCommands.back());
+            char shortCommand = i < shortCommandCharactersSize ? shortCommandCharacters[i] : '\0';
+            if (shortCommand != '\0')
+                option->AddShortCommand(shortCommand);
+            shortCommands.push_back(shortCommand);
+            options.push_back(option);
+        }
+    }
+
+    SyntheticSchema(const SyntheticSchema &) = delete;
+
+    SyntheticSchema &operator=(const SyntheticSchema &) = delete;
+
+    ~SyntheticSchema() {
+        for (auto option: options)
+            delete option;
+    }
+
+    static bool isInputOption(int index) {
+        return index % 4 == 3;
+    }
+
+    [[nodiscard]] int size() const {
+        return (int) options.size();
+    }
+};
+
+class SyntheticArgv {
+    std::vector<std::string> storage;
+    std::vector<char *> pointers;
+    unsigned long long state = 0x9E3779B97F4A7C15ull;
+
+    unsigned next(unsigned bound) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return (unsigned) ((state >> 33) % bound);
+    }
+
+    int pickOption(const SyntheticSchema &schema, bool needsShortCommand, bool input) {
+        int range = needsShortCommand ? std::min(schema.size(), shortCommandCharactersSize) : schema.size();
+        for (int attempts = 0; attempts < 16; attempts++) {
+            int index = (int) next(range);
+            if (SyntheticSchema::isInputOption(index) == input)
+                return index;
+        }
+        return -1;
+    }
+
+public:
+    SyntheticArgv(const SyntheticSchema &schema, int tokenCount, unsigned long long seed = 0x9E3779B97F4A7C15ull) : state(seed) {
+        storage.reserve(tokenCount + 1);
+        storage.emplace_back("bench");
+        while ((int) storage.size() <= tokenCount) {
+            int remaining = tokenCount - (int) storage.size() + 1;
+            int index;
+            switch (next(6)) {
+                case 0:
+                    if ((index = pickOption(schema, false, false)) < 0)
+                        break;
+                    storage.emplace_back("--" + schema.longCommands[index]);
+                    continue;
+                case 1:
+                    if ((index = pickOption(schema, false, true)) < 0)
+                        break;
+                    storage.emplace_back("--" + schema.longCommands[index] + "=value" + std::to_string(index));
+                    continue;
+                case 2:
+                    if (remaining < 2 || (index = pickOption(schema, false, true)) < 0)
+                        break;
+                    storage.emplace_back("--" + schema.longCommands[index]);
+                    storage.emplace_back("separate-value");
+                    continue;
+                case 3: {
+                    std::string cluster = "-";
+                    for (int i = 0; i < 3; i++)
+                        if ((index = pickOption(schema, true, false)) >= 0 && cluster.find(schema.shortCommands[index]) == std::string::npos)
+                            cluster += schema.shortCommands[index];
+                    if (cluster.size() < 2)
+                        break;
+                    storage.emplace_back(std::move(cluster));
+                    continue;
+                }
+                case 4:
+                    if (remaining < 2 || (index = pickOption(schema, true, true)) < 0)
+                        break;
+                    storage.emplace_back(std::string("-") + schema.shortCommands[index]);
+                    storage.emplace_back("short-value");
+                    continue;
+                default:
+                    break;
+            }
+            storage.emplace_back("positional" + std::to_string(storage.size()));
+        }
+        pointers.reserve(storage.size() + 1);
+        for (auto &str: storage)
+            pointers.push_back(str.data());
+        pointers.push_back(nullptr);
+    }
+
+    [[nodiscard]] int argc() const {
+        return (int) storage.size();
+    }
+
+    [[nodiscard]] char **argv() {
+        return pointers.data();
+    }
+};
+
+/* ------ measuring ------ */
+using Clock = std::chrono::steady_clock;
+
+struct Measurement {
+    double nanoseconds = 0;
+    double allocations = 0;
+};
+
+/**
+ * Runs the function until at least minimumWork units were processed (and at least 3 times), or until the time budget runs out.
+ * @return the average time per unit of work and the average amount of allocations per call.
+ */
+template<typename Function>
+Measurement measure(long long minimumWork, long long workPerRun, Function &&function) {
+    const auto timeBudget = std::chrono::seconds(1);
+    workPerRun = std::max(1LL, workPerRun);
+    long long runs = std::max(3LL, minimumWork / workPerRun), completedRuns = 0;
+    function(); //warm up
+    size_t allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+    auto start = Clock::now();
+    while (completedRuns < runs) {
+        function();
+        completedRuns++;
+        if (Clock::now() - start > timeBudget)
+            break;
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    size_t allocations = allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+    return {elapsed / (double) (completedRuns * workPerRun), (double) allocations / (double) completedRuns};
+}
+
+long peakMemoryKiB() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+int getoptLongParse(int argc, char **argv, const std::string &shortOptions, const std::vector<option> &longOptions) {
+    optind = 0;
+    opterr = 0;
+    int count = 0, result;
+    while ((result = getopt_long(argc, argv, shortOptions.c_str(), longOptions.data(), nullptr)) != -1)
+        count += result != '?';
+    return count;
+}
+
+void benchmarkParse(const SyntheticSchema &schema, int tokenCount, long long minimumWork) {
+    SyntheticArgv syntheticArgv(schema, tokenCount);
+    DArgumentParser parser(syntheticArgv.argc(), syntheticArgv.argv());
+    for (auto option: schema.options)
+        parser.AddArgumentOption(option);
+    DParseResult parseResult = parser.Parse();
+    if (parseResult != DParseResult::ParseSuccessful)
+        std::fprintf(stderr, "unexpected parse failure: %s\n", parser.ErrorText().c_str());
+    Measurement parse = measure(minimumWork, tokenCount, [&parser]() { (void) parser.Parse(); });
+
+    std::string shortOptions = "-:";
+    std::vector<option> longOptions;
+    longOptions.reserve(schema.size() + 1);
+    for (int i = 0; i < schema.size(); i++) {
+        bool input = SyntheticSchema::isInputOption(i);
+        if (schema.shortCommands[i] != '\0') {
+            shortOptions += schema.shortCommands[i];
+            if (input)
+                shortOptions += ':';
+        }
+        longOptions.push_back({schema.longCommands[i].c_str(), input ? required_argument : no_argument, nullptr, 1000 + i});
+    }
+    longOptions.push_back({nullptr, 0, nullptr, 0});
+    Measurement getopt = measure(minimumWork, tokenCount, [&]() { (void) getoptLongParse(syntheticArgv.argc(), syntheticArgv.argv(), shortOptions, longOptions); });
+
+    std::printf("%-12s %8d %9d %12.2f %12.2f %14.1f %10ld\n", "Parse", schema.size(), tokenCount, parse.nanoseconds, getopt.nanoseconds, parse.allocations, peakMemoryKiB());
+
+    //a fresh parser per run, built and parsed entirely inside a monotonic buffer, the global heap is only used if the buffer runs out
+    std::vector<std::byte> arena((size_t) schema.size() * 256 + (size_t) tokenCount * 64 + 65536);
+    Measurement arenaParse = measure(minimumWork, tokenCount, [&]() {
+        std::pmr::monotonic_buffer_resource resource(arena.data(), arena.size(), std::pmr::new_delete_resource());
+        DArgumentParser arenaParser(syntheticArgv.argc(), syntheticArgv.argv(), &resource);
+        for (auto option: schema.options)
+            arenaParser.AddArgumentOption(option);
+        (void) arenaParser.Parse();
+    });
+    std::printf("%-12s %8d %9d %12.2f %12s %14.1f %10ld\n", "ParsePmr", schema.size(), tokenCount, arenaParse.nanoseconds, "-", arenaParse.allocations, peakMemoryKiB());
+
+    //a helper that only checks two options before exiting
+    volatile int sink = 0;
+    Measurement lazyParse = measure(minimumWork, tokenCount, [&]() {
+        (void) parser.ParseLazily();
+        sink = sink + parser.WasSet(schema.longCommands[0]) + parser.WasSet(schema.longCommands[schema.size() - 1]);
+    });
+    std::printf("%-12s %8d %9d %12.2f %12s %14.1f %10ld\n", "ParseLazy", schema.size(), tokenCount, lazyParse.nanoseconds, "-", lazyParse.allocations, peakMemoryKiB());
+
+    //every option bound to a variable, written while parsing instead of being looked up afterwards
+    std::vector<int> counters(schema.size());
+    std::vector<std::string> values(schema.size());
+    for (int i = 0; i < schema.size(); i++)
+        (void) (SyntheticSchema::isInputOption(i) ? schema.options[i]->Bind(values[i]) : schema.options[i]->Bind(counters[i]));
+    Measurement boundParse = measure(minimumWork, tokenCount, [&parser]() { (void) parser.Parse(); });
+    for (auto option: schema.options)
+        option->Unbind();
+    std::printf("%-12s %8d %9d %12.2f %12s %14.1f %10ld\n", "ParseBound", schema.size(), tokenCount, boundParse.nanoseconds, "-", boundParse.allocations, peakMemoryKiB());
+
+    //an interactive shell retyping the last argument, the edit and its undo are reported per edit, independent of the argument count
+    std::string lastArgument = syntheticArgv.argv()[syntheticArgv.argc() - 1];
+    (void) parser.BeginArgumentEditing();
+    Measurement edit = measure(minimumWork / 10, 2, [&]() {
+        (void) parser.ReplaceLastArgument(lastArgument);
+        (void) parser.UndoArgumentEdit();
+    });
+    std::printf("%-12s %8d %9d %12.2f %12s %14.1f %10ld\n", "EditLast", schema.size(), tokenCount, edit.nanoseconds, "-", edit.allocations, peakMemoryKiB());
+
+    //shared immutable schema, each run returns its own outcome
+    DArgumentSchema argumentSchema = parser.CreateSchema();
+    Measurement schemaParse = measure(minimumWork, tokenCount, [&]() { (void) argumentSchema.Parse(syntheticArgv.argc(), syntheticArgv.argv()); });
+    std::printf("%-12s %8d %9d %12.2f %12s %14.1f %10ld\n", "ParseSchema", schema.size(), tokenCount, schemaParse.nanoseconds, "-", schemaParse.allocations, peakMemoryKiB());
+}
+
+/**
+ * Splits a command string made of the synthetic argv, with every tenth argument quoted, reporting the time per byte (copying the string back in place before each run is included).
+ */
+void benchmarkTokenize(const SyntheticSchema &schema, int tokenCount, long long minimumWork) {
+    SyntheticArgv syntheticArgv(schema, tokenCount);
+    std::string commandString;
+    for (int index = 1; index < syntheticArgv.argc(); index++) {
+        if (index % 10 == 0)
+            commandString.append("\"quoted ").append(syntheticArgv.argv()[index]).append("\" ");
+        else
+            commandString.append(syntheticArgv.argv()[index]).append(" ");
+    }
+    std::string buffer = commandString;
+    std::pmr::vector<std::string_view> arguments;
+    arguments.reserve(tokenCount);
+    Measurement tokenize = measure(minimumWork * 10, (long long) commandString.size(), [&]() {
+        buffer.assign(commandString);
+        arguments.clear();
+        DCommandTokenizer::TokenizeInPlace(buffer.data(), buffer.data() + buffer.size(), arguments);
+    });
+    std::printf("%-12s %8d %9d %12.2f %12s %14.1f %10ld\n", "Tokenize", schema.size(), tokenCount, tokenize.nanoseconds, "-", tokenize.allocations, peakMemoryKiB());
+}
+
+/**
+ * Parses a compiler-like command line passing the same two options over and over ("-I dir -D name"), with every value kept, reporting the time per argument.
+ */
+void benchmarkMultipleValues(int tokenCount, long long minimumWork) {
+    std::vector<std::string> storage;
+    storage.reserve(tokenCount);
+    std::vector<char *> argv{(char *) "bench"};
+    for (int i = 0; i < tokenCount / 2; i++) {
+        argv.push_back((char *) (i % 2 == 0 ? "-I" : "-D"));
+        argv.push_back(storage.emplace_back("value-" + std::to_string(i)).data());
+    }
+    argv.push_back(nullptr);
+    DArgumentOption includeOption(DArgumentOptionType::InputOption, "include directory"), defineOption(DArgumentOptionType::InputOption, "macro definition");
+    includeOption.AddShortCommand('I');
+    defineOption.AddShortCommand('D');
+    includeOption.SetMultipleValues(true);
+    defineOption.SetMultipleValues(true);
+    DArgumentParser parser((int) argv.size() - 1, argv.data());
+    parser.AddArgumentOption(includeOption);
+    parser.AddArgumentOption(defineOption);
+    Measurement parse = measure(minimumWork, (long long) argv.size() - 2, [&parser]() { (void) parser.Parse(); });
+    std::printf("%-12s %8d %9d %12.2f %12s %14.1f %10ld\n", "ParseMulti", 2, (int) argv.size() - 2, parse.nanoseconds, "-", parse.allocations, peakMemoryKiB());
+}
+
+/**
+ * Parses a buffer of command lines with tokenCount tokens each, with one thread and with one per hardware thread, reporting the time per command line.
+ */
+void benchmarkBatch(const SyntheticSchema &schema, int tokenCount, long long minimumWork) {
+    std::string buffer;
+    int lineCount = (int) std::max(1000LL, minimumWork / 20);
+    for (int line = 0; line < lineCount; line++) {
+        SyntheticArgv syntheticArgv(schema, tokenCount, 0x9E3779B97F4A7C15ull + line);
+        for (int index = 0; index < syntheticArgv.argc(); index++) {
+            buffer += syntheticArgv.argv()[index];
+            buffer += index + 1 < syntheticArgv.argc() ? ' ' : '\n';
+        }
+    }
+    char *argv[] = {(char *) "bench", nullptr};
+    DArgumentParser parser(1, argv);
+    for (auto option: schema.options)
+        parser.AddArgumentOption(option);
+    DArgumentSchema argumentSchema = parser.CreateSchema();
+    unsigned hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threadCount: {1u, hardwareThreads}) {
+        Measurement batch = measure(minimumWork, lineCount, [&]() { (void) argumentSchema.ParseBatch(buffer, '\n', threadCount); });
+        std::string workload = "Batch/" + std::to_string(threadCount);
+        std::printf("%-12s %8d %9d %12.2f %12s %14.1f %10ld\n", workload.c_str(), schema.size(), tokenCount, batch.nanoseconds, "-", batch.allocations, peakMemoryKiB());
+        if (threadCount == hardwareThreads)
+            break;
+    }
+}
+
+/**
+ * Loads a config file setting every option of the schema and parses an empty argv with it, reporting the time per entry.
+ */
+void benchmarkConfigFile(const SyntheticSchema &schema, long long minimumWork) {
+    char path[] = "/tmp/DArgumentParserBenchXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+        return;
+    std::string contents = "[synthetic]\n";
+    for (int i = 0; i < schema.size(); i++)
+        contents.append(schema.longCommands[i]).append(SyntheticSchema::isInputOption(i) ? " = value-" + std::to_string(i) + "\n" : "\n");
+    bool written = write(fd, contents.data(), contents.size()) == (ssize_t) contents.size();
+    close(fd);
+    char *argv[] = {(char *) "bench", nullptr};
+    DArgumentParser parser(1, argv);
+    for (auto option: schema.options)
+        parser.AddArgumentOption(option);
+    if (written) {
+        Measurement load = measure(minimumWork, schema.size(), [&]() {
+            parser.ClearConfigFile();
+            parser.LoadConfigFile(path);
+        });
+        std::printf("%-12s %8d %9s %12.2f %12s %14.1f %10ld\n", "ConfigLoad", schema.size(), "-", load.nanoseconds, "-", load.allocations, peakMemoryKiB());
+        Measurement reload = measure(minimumWork / 100, 1, [&]() { parser.LoadConfigFile(path); });
+        std::printf("%-12s %8d %9s %12.2f %12s %14.1f %10ld\n", "ConfigReload", schema.size(), "-", reload.nanoseconds, "-", reload.allocations, peakMemoryKiB());
+        Measurement parse = measure(minimumWork, schema.size(), [&]() { parser.Parse(); });
+        std::printf("%-12s %8d %9s %12.2f %12s %14.1f %10ld\n", "ConfigParse", schema.size(), "-", parse.nanoseconds, "-", parse.allocations, peakMemoryKiB());
+    }
+    unlink(path);
+}
+
+/**
+ * Registers one subcommand per option of the schema and parses an argv selecting one of them, reporting the time per subcommand registered.
+ */
+void benchmarkSubcommands(const SyntheticSchema &schema, long long minimumWork) {
+    std::string selected = "command-" + std::to_string(schema.size() / 2), value = "value";
+    char *argv[] = {(char *) "bench", selected.data(), (char *) "--option-0", value.data(), nullptr};
+    Measurement subcommands = measure(minimumWork, schema.size(), [&]() {
+        DArgumentParser parser(4, argv);
+        for (int i = 0; i < schema.size(); i++)
+            parser.AddSubcommand("command-" + std::to_string(i), "Synthetic subcommand.", [&schema](DArgumentParser &subcommand) { subcommand.AddArgumentOption(schema.options[0]); });
+        parser.Parse();
+    });
+    std::printf("%-12s %8d %9s %12.2f %12s %14.1f %10ld\n", "Subcommands", schema.size(), "-", subcommands.nanoseconds, "-", subcommands.allocations, peakMemoryKiB());
+}
+
+/**
+ * Answers a __complete query for a long command prefix into a string, reporting the time per query (the parser is created once, like the options of the program would be).
+ */
+void benchmarkCompletion(const SyntheticSchema &schema, long long minimumWork) {
+    std::string prefix = "--option-" + std::to_string(schema.size() - 1);
+    char *argv[] = {(char *) "bench", (char *) "__complete", prefix.data(), nullptr};
+    DArgumentParser parser(3, argv);
+    for (auto option: schema.options)
+        parser.AddArgumentOption(option);
+    std::string output;
+    DStringHelpSink sink(output);
+    Measurement completion = measure(minimumWork / 100, 1, [&]() {
+        output.clear();
+        (void) parser.WriteCompletions(sink);
+    });
+    std::printf("%-12s %8d %9s %12.2f %12s %14.1f %10ld\n", "Complete", schema.size(), "-", completion.nanoseconds, "-", completion.allocations, peakMemoryKiB());
+}
+
+/**
+ * Parses a long command with two characters swapped, reporting the time per failed parse including the suggestions for it (the error path the typo takes without them is the baseline).
+ */
+void benchmarkSuggestion(const SyntheticSchema &schema, long long minimumWork) {
+    std::string typo = "--" + schema.longCommands[schema.size() / 2];
+    std::swap(typo[2], typo[3]);
+    char *argv[] = {(char *) "bench", typo.data(), nullptr};
+    DArgumentParser parser(2, argv);
+    for (auto option: schema.options)
+        parser.AddArgumentOption(option);
+    if (parser.Parse() != DParseResult::InvalidOption || parser.GetSuggestions().empty())
+        std::fprintf(stderr, "unexpected suggestions for %s: %s\n", typo.c_str(), parser.ErrorText().c_str());
+    Measurement suggestion = measure(minimumWork / 100, 1, [&parser]() { (void) parser.Parse(); });
+    std::printf("%-12s %8d %9d %12.2f %12s %14.1f %10ld\n", "Suggest", schema.size(), 1, suggestion.nanoseconds, "-", suggestion.allocations, peakMemoryKiB());
+}
+
+/**
+ * Compares a whole program startup, registering the schema and parsing a short argv, against opening a schema image of the same options and parsing the same argv.
+ */
+void benchmarkSchemaImage(const SyntheticSchema &schema, long long minimumWork) {
+    std::string longCommand = "--" + schema.longCommands[schema.size() / 2];
+    char *argv[] = {(char *) "bench", longCommand.data(), (char *) "positional", nullptr};
+    char path[] = "/tmp/DArgumentParserBenchXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+        return;
+    DArgumentParser schemaParser(1, argv);
+    for (auto option: schema.options)
+        schemaParser.AddArgumentOption(option);
+    std::string image = schemaParser.CreateSchemaImage();
+    bool written = write(fd, image.data(), image.size()) == (ssize_t) image.size();
+    close(fd);
+    if (written) {
+        Measurement startup = measure(minimumWork / 100, 1, [&]() {
+            DArgumentParser parser(3, argv);
+            for (auto option: schema.options)
+                parser.AddArgumentOption(option);
+            parser.Parse();
+        });
+        std::printf("%-12s %8d %9s %12.2f %12s %14.1f %10ld\n", "Startup", schema.size(), "-", startup.nanoseconds, "-", startup.allocations, peakMemoryKiB());
+        Measurement imageStartup = measure(minimumWork / 100, 1, [&]() {
+            DMappedArgumentParser parser(3, argv);
+            parser.Open(path);
+            parser.Parse();
+        });
+        std::printf("%-12s %8d %9s %12.2f %12s %14.1f %10ld\n", "ImageStartup", schema.size(), "-", imageStartup.nanoseconds, "-", imageStartup.allocations, peakMemoryKiB());
+    }
+    unlink(path);
+}
+
+void benchmarkWasSet(const SyntheticSchema &schema, long long minimumWork) {
+    char *argv[] = {(char *) "bench", nullptr};
+    DArgumentParser parser(1, argv);
+    for (auto option: schema.options)
+        parser.AddArgumentOption(option);
+    volatile int sink = 0;
+    Measurement lookups = measure(minimumWork, schema.size() * 2LL, [&]() {
+        for (int i = 0; i < schema.size(); i++) {
+            sink = sink + parser.WasSet(schema.longCommands[i]);
+            sink = sink + parser.WasSet(schema.shortCommands[i]);
+        }
+    });
+    std::printf("%-12s %8d %9s %12.2f %12s %14.1f %10ld\n", "WasSet", schema.size(), "-", lookups.nanoseconds, "-", lookups.allocations, peakMemoryKiB());
+}
+
+void benchmarkRegistration(const SyntheticSchema &schema, long long minimumWork) {
+    char *argv[] = {(char *) "bench", nullptr};
+    Measurement registration = measure(minimumWork, schema.size(), [&]() {
+        DArgumentParser parser(1, argv);
+        for (auto option: schema.options)
+            parser.AddArgumentOption(option);
+    });
+    std::printf("%-12s %8d %9s %12.2f %12s %14.1f %10ld\n", "AddOption", schema.size(), "-", registration.nanoseconds, "-", registration.allocations, peakMemoryKiB());
+
+    //the whole schema in a single call, building the set passed to it is included
+    Measurement batchRegistration = measure(minimumWork, schema.size(), [&]() {
+        DArgumentParser parser(1, argv);
+        parser.AddArgumentOption(std::unordered_set<DArgumentOption *>(schema.options.begin(), schema.options.end()));
+    });
+    std::printf("%-12s %8d %9s %12.2f %12s %14.1f %10ld\n", "AddBatch", schema.size(), "-", batchRegistration.nanoseconds, "-", batchRegistration.allocations, peakMemoryKiB());
+}
+
+void benchmarkHelpText(const SyntheticSchema &schema, long long minimumWork) {
+    char *argv[] = {(char *) "bench", nullptr};
+    DArgumentParser parser(1, argv, "bench", "1.0", "Synthetic schema used for benchmarking.");
+    parser.AddPositionalArgument("file", "A positional argument.");
+    for (auto option: schema.options)
+        parser.AddArgumentOption(option);
+    volatile size_t sink = 0;
+    //changing the description invalidates the cached help text, so every call generates it again
+    Measurement help = measure(minimumWork / 100, schema.size(), [&]() {
+        parser.SetAppDescription("Synthetic schema used for benchmarking.");
+        sink = sink + parser.HelpText().size();
+    });
+    std::printf("%-12s %8d %9s %12.2f %12s %14.1f %10ld\n", "HelpText", schema.size(), "-", help.nanoseconds, "-", help.allocations, peakMemoryKiB());
+    Measurement cachedHelp = measure(minimumWork, schema.size(), [&]() { sink = sink + parser.HelpText().size(); });
+    std::printf("%-12s %8d %9s %12.2f %12s %14.1f %10ld\n", "HelpCached", schema.size(), "-", cachedHelp.nanoseconds, "-", cachedHelp.allocations, peakMemoryKiB());
+    int devNull = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    DFileDescriptorHelpSink helpSink(devNull);
+    Measurement writeHelp = measure(minimumWork / 10, schema.size(), [&]() { parser.WriteHelp(helpSink); });
+    close(devNull);
+    std::printf("%-12s %8d %9s %12.2f %12s %14.1f %10ld\n", "WriteHelp", schema.size(), "-", writeHelp.nanoseconds, "-", writeHelp.allocations, peakMemoryKiB());
+}
+
+/* ------ checks ------ */
+static int failedChecks = 0;
+
+void check(bool condition, const char *description) {
+    if (condition)
+        return;
+    failedChecks++;
+    std::fprintf(stderr, "check failed: %s\n", description);
+}
+
+/**
+ * Writes the contents to a new file for the checks that load files, the caller unlinks it.
+ * @return Returns the path of the file, or an empty string if it couldn't be written.
+ */
+std::string writeCheckFile(const std::string &contents) {
+    char path[] = "/tmp/DArgumentParserChecksXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+        return std::string();
+    bool written = write(fd, contents.data(), contents.size()) == (ssize_t) contents.size();
+    close(fd);
+    if (!written) {
+        unlink(path);
+        return std::string();
+    }
+    return path;
+}
+
+/**
+ * The cached help text has to follow the options added after it was generated, even when the layout was updated in between by WriteHelp.
+ */
+void checkHelpTextCache() {
+    char *argv[] = {(char *) "check", nullptr};
+    DArgumentParser parser(1, argv);
+    DArgumentOption first({'f'}, {"first"}, "First option."), second({'s'}, {"second"}, "Second option.");
+    parser.AddArgumentOption(first);
+    std::string before = parser.HelpText();
+    parser.AddArgumentOption(second);
+    std::string written;
+    DStringHelpSink sink(written);
+    parser.WriteHelp(sink);
+    const std::string &after = parser.HelpText();
+    check(before.find("--second") == std::string::npos, "help text before the option is added doesn't list it");
+    check(after.find("--second") != std::string::npos, "HelpText lists an option added after WriteHelp");
+    check(after == written, "HelpText matches what WriteHelp wrote");
+}
+
+/**
+ * Splits a command string one character at a time, with the same rules as DCommandTokenizer.
+ */
+std::vector<std::string> referenceTokenize(std::string_view text) {
+    auto isWhitespace = [](char c) { return c == ' ' || (c >= '\t' && c <= '\r'); };
+    std::vector<std::string> arguments;
+    size_t index = 0;
+    while (true) {
+        while (index < text.size() && isWhitespace(text[index]))
+            index++;
+        if (index == text.size())
+            return arguments;
+        std::string argument;
+        while (index < text.size() && !isWhitespace(text[index])) {
+            char c = text[index++];
+            if (c == '\'') {
+                for (; index < text.size() && text[index] != '\''; index++)
+                    argument += text[index];
+                index += index < text.size();
+            } else if (c == '"') {
+                while (index < text.size() && text[index] != '"') {
+                    c = text[index++];
+                    argument += c == '\\' && index < text.size() ? text[index++] : c;
+                }
+                index += index < text.size();
+            } else
+                argument += c == '\\' && index < text.size() ? text[index++] : c;
+        }
+        arguments.push_back(std::move(argument));
+    }
+}
+
+/**
+ * Compares the vectorized tokenizer with the reference on a few known command strings and on generated ones, long enough to cross the 64 byte blocks with quotes and escapes at every position.
+ */
+void checkTokenizer() {
+    auto tokenize = [](std::string text) {
+        std::pmr::vector<std::string_view> views;
+        DCommandTokenizer::TokenizeInPlace(text.data(), text.data() + text.size(), views);
+        return std::vector<std::string>(views.begin(), views.end());
+    };
+    check(tokenize("  --name 'a b'  \"c \\\" d\" e\\ f ''") == std::vector<std::string>{"--name", "a b", "c \" d", "e f", ""}, "tokenizer splits quotes and escapes");
+    check(tokenize(" \t\n ").empty(), "tokenizer skips whitespace only strings");
+    check(tokenize("trailing\\") == std::vector<std::string>{"trailing\\"}, "tokenizer keeps a trailing backslash");
+    const char alphabet[] = "ab-= \t\n'\"\\\xe9";
+    unsigned long long state = 0x2545F4914F6CDD1Dull;
+    auto next = [&state](unsigned bound) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return (unsigned) ((state >> 33) % bound);
+    };
+    int mismatches = 0;
+    for (int round = 0; round < 20000; round++) {
+        std::string text(next(300), ' ');
+        //mostly plain characters, so runs long enough for the whole block path show up too
+        for (char &c: text)
+            c = next(4) != 0 ? alphabet[next(2)] : alphabet[next(sizeof(alphabet) - 1)];
+        mismatches += tokenize(text) != referenceTokenize(text);
+    }
+    check(mismatches == 0, "tokenizer matches the reference on generated command strings");
+}
+
+/**
+ * Edit distance between two strings counting a swap of adjacent characters as a single edit, with the whole dynamic programming table.
+ */
+size_t referenceEditDistance(std::string_view first, std::string_view second) {
+    std::vector<std::vector<size_t>> distances(first.size() + 1, std::vector<size_t>(second.size() + 1));
+    for (size_t i = 0; i <= first.size(); i++)
+        for (size_t j = 0; j <= second.size(); j++) {
+            if (i == 0 || j == 0) {
+                distances[i][j] = i + j;
+                continue;
+            }
+            distances[i][j] = std::min({distances[i - 1][j] + 1, distances[i][j - 1] + 1, distances[i - 1][j - 1] + (first[i - 1] != second[j - 1])});
+            if (i > 1 && j > 1 && first[i - 1] == second[j - 2] && first[i - 2] == second[j - 1])
+                distances[i][j] = std::min(distances[i][j], distances[i - 2][j - 2] + 1);
+        }
+    return distances[first.size()][second.size()];
+}
+
+/**
+ * @return Returns the long commands a parser with the given ones suggests for an invalid command, after parsing it.
+ */
+std::vector<std::string> suggestionsFor(const std::vector<std::string> &commands, const std::string &command) {
+    std::deque<DArgumentOption> options;
+    std::string argument = "--" + command;
+    char *argv[] = {(char *) "check", argument.data(), nullptr};
+    DArgumentParser parser(2, argv);
+    for (const auto &longCommand: commands)
+        parser.AddArgumentOption(options.emplace_back(std::set<char>(), std::set<std::string>{longCommand}));
+    if (parser.Parse() != DParseResult::InvalidOption)
+        return {};
+    return std::vector<std::string>(parser.GetSuggestions().begin(), parser.GetSuggestions().end());
+}
+
+/**
+ * Compares the suggestions for invalid long commands with the closest commands found by comparing the command with every one of them.
+ */
+void checkSuggestions() {
+    const std::vector<std::string> knownCommands{"verbose", "version", "jobs", "output", "outputs", "input"};
+    check(suggestionsFor(knownCommands, "verbos") == std::vector<std::string>{"verbose"}, "suggestions find a missing character");
+    check(suggestionsFor(knownCommands, "jbos") == std::vector<std::string>{"jobs"}, "suggestions count a swap as one edit");
+    check(suggestionsFor(knownCommands, "x").empty(), "suggestions skip commands too far away");
+    unsigned long long state = 0xD1B54A32D192ED03ull;
+    auto next = [&state](unsigned bound) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return (unsigned) ((state >> 33) % bound);
+    };
+    auto randomCommand = [&next](size_t size) {
+        std::string command(size, 'a');
+        for (char &c: command)
+            c = (char) ('a' + next(6));
+        return command;
+    };
+    int mismatches = 0;
+    for (int round = 0; round < 200; round++) {
+        std::set<std::string> uniqueCommands;
+        while (uniqueCommands.size() < 40)
+            uniqueCommands.insert(randomCommand(1 + next(12)));
+        std::vector<std::string> commands(uniqueCommands.begin(), uniqueCommands.end());
+        //mostly typos of a command, so there's something to suggest
+        std::string command = commands[next((unsigned) commands.size())];
+        for (unsigned edits = next(4); edits > 0; edits--) {
+            size_t position = next((unsigned) command.size() + 1);
+            unsigned kind = next(4);
+            if (kind == 0)
+                command.insert(position, 1, (char) ('a' + next(6)));
+            else if (position < command.size() && kind == 1)
+                command.erase(position, 1);
+            else if (position < command.size() && kind == 2)
+                command[position] = (char) ('a' + next(6));
+            else if (position + 1 < command.size())
+                std::swap(command[position], command[position + 1]);
+        }
+        if (round % 4 == 0)
+            command = randomCommand(1 + next(14));
+        if (command.empty() || uniqueCommands.count(command) != 0)
+            continue;
+        //the distance allowed grows with the size of the command, as the parser allows it
+        size_t maxDistance = std::clamp<size_t>((command.size() + 2) / 4, 1, 3);
+        std::vector<std::pair<size_t, std::string>> closest;
+        for (const auto &candidate: commands) {
+            size_t distance = referenceEditDistance(command, candidate);
+            if (distance <= maxDistance)
+                closest.emplace_back(distance, candidate);
+        }
+        std::sort(closest.begin(), closest.end());
+        std::vector<std::string> expected;
+        for (size_t index = 0; index < closest.size() && index < 3; index++)
+            expected.push_back(closest[index].second);
+        mismatches += suggestionsFor(commands, command) != expected;
+    }
+    check(mismatches == 0, "suggestions match the closest commands by brute force");
+}
+
+/**
+ * The options of the argument editing check, with environment variables and config entries for the fallback sources.
+ */
+struct EditingSchema {
+    DArgumentOption verbose{{'v'}, {"verbose"}};
+    DArgumentOption quiet{{'q'}, {"quiet"}};
+    DArgumentOption output{DArgumentOptionType::InputOption, {'o'}, {"output"}};
+    DArgumentOption include{DArgumentOptionType::InputOption, {'I'}, {"include"}};
+    DArgumentOption number{DArgumentOptionType::InputOption, {'n'}, {"num"}};
+
+    EditingSchema(DArgumentParser &parser, char **environment, const char *configPath) {
+        verbose.SetEnvironmentVariable("CHECK_VERBOSE");
+        output.SetEnvironmentVariable("CHECK_OUTPUT");
+        include.SetEnvironmentVariable("CHECK_INCLUDE");
+        include.SetMultipleValues(true);
+        number.SetEnvironmentVariable("CHECK_NUM");
+        number.SetValueType(DArgumentValueType::Integer);
+        parser.AddArgumentOption({&verbose, &quiet, &output, &include, &number});
+        parser.SetEnvironment(environment);
+        parser.LoadConfigFile(configPath);
+    }
+
+    /**
+     * @return Returns the result, the error and everything the parse set, as text.
+     */
+    std::string describe(DArgumentParser &parser, DParseResult result) const {
+        std::string text = std::to_string((int) result) + " " + parser.ErrorText();
+        for (auto option: {&verbose, &quiet, &output, &include, &number}) {
+            text += " | " + std::to_string(option->WasSet()) + " " + std::to_string((int) option->GetValueSource()) + " " + std::to_string(option->GetIntegerValue());
+            for (auto value: option->GetValues())
+                text.append(" ").append(value);
+        }
+        for (auto argument: parser.GetPositionalArgumentViews())
+            text.append(" | ").append(argument);
+        for (const auto &occurrence: parser.GetOccurrences())
+            text.append(" | ").append(occurrence.value);
+        return text;
+    }
+};
+
+/**
+ * Checks that values and positional arguments are views into argv, that the strings created from them follow the next parse, and the error of every malformed option.
+ */
+void checkArgumentViews() {
+    char *argv[] = {(char *) "check", (char *) "--output=file", (char *) "-o", (char *) "second", (char *) "positional", (char *) "-v", nullptr};
+    DArgumentParser parser(6, argv);
+    DArgumentOption verbose({'v'}, {"verbose"}), quiet({'q'}, {"quiet"}), output(DArgumentOptionType::InputOption, {'o'}, {"output"});
+    parser.AddArgumentOption({&verbose, &quiet, &output});
+    bool parsed = parser.Parse() == DParseResult::ParseSuccessful;
+    check(parsed && output.GetValueView().data() == argv[3] && parser.GetPositionalArgumentViews().size() == 1 && parser.GetPositionalArgumentViews()[0].data() == argv[4], "values and positional arguments are views into argv");
+    check(output.GetValue() == "second" && parser.GetPositionalArguments() == std::vector<std::string>{"positional"} && verbose.WasSet() == 1, "values and positional arguments are read as strings");
+    parsed = parser.ParseCommandString("-o third") == DParseResult::ParseSuccessful;
+    check(parsed && output.GetValue() == "third" && parser.GetPositionalArguments().empty() && !verbose.WasSet(), "the strings of values and positional arguments follow the next parse");
+    const std::pair<const char *, DParseResult> failures[] = {
+            {"--verbose=1", DParseResult::ValuePassedToOptionThatDoesNotTakeValue},
+            {"--output", DParseResult::NoValueWasPassedToOption},
+            {"--output=", DParseResult::NoValueWasPassedToOption},
+            {"-o", DParseResult::NoValueWasPassedToOption},
+            {"-ov x", DParseResult::OptionsThatTakesValueNeedsToBeSetSeparately},
+            {"--bogus", DParseResult::InvalidOption},
+            {"-x", DParseResult::InvalidOption}};
+    const char *errors[] = {
+            "Option --verbose received a value but it doesn't take any",
+            "Option --output takes a value but none was passed.",
+            "Option --output takes a value but none was passed.",
+            "Option -o takes a value but none was passed.",
+            "Options that takes a value needs to be set separately. Error with option: -o",
+            "Option --bogus is invalid",
+            "Option -x is invalid"};
+    int mismatches = 0;
+    for (size_t index = 0; index < sizeof(failures) / sizeof(failures[0]); index++) {
+        DParseResult result = parser.ParseCommandString(failures[index].first);
+        if ((result != failures[index].second || parser.ErrorText().rfind(errors[index], 0) != 0) && mismatches++ == 0)
+            std::fprintf(stderr, "first error mismatch: %s returned %d, %s\n", failures[index].first, (int) result, parser.ErrorText().c_str());
+    }
+    check(mismatches == 0, "malformed options fail with their own result and error text");
+}
+
+struct StaticVerboseOption : DStaticOption {
+    static constexpr std::string_view shortCommands = "v";
+    static constexpr std::string_view longCommands[] = {"verbose"};
+};
+
+struct StaticQuietOption : DStaticOption {
+    static constexpr std::string_view shortCommands = "q";
+    static constexpr std::string_view longCommands[] = {"quiet"};
+};
+
+struct StaticOutputOption : DStaticOption {
+    static constexpr DArgumentOptionType type = DArgumentOptionType::InputOption;
+    static constexpr std::string_view shortCommands = "o";
+    static constexpr std::string_view longCommands[] = {"out", "output"};
+};
+
+/**
+ * Parses generated argv vectors with DStaticArgumentParser and DArgumentParser, comparing the results, the values, the positional arguments and the error texts.
+ */
+void checkStaticParser() {
+    const char *tokens[] = {"-v", "-vo", "-ov", "-o", "x", "--output=y", "--output", "--out", "--out=", "--verbose", "--verbose=1", "--quiet", "--bogus", "-q", "-qv", "-z", "pos", "-"};
+    unsigned long long state = 0xD1B54A32D192ED03ull;
+    auto next = [&state](unsigned bound) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return (unsigned) ((state >> 33) % bound);
+    };
+    int mismatches = 0;
+    for (int round = 0; round < 2000; round++) {
+        std::vector<char *> argv{(char *) "check"};
+        for (unsigned count = next(6); count > 0; count--)
+            argv.push_back((char *) tokens[next(sizeof(tokens) / sizeof(tokens[0]))]);
+        argv.push_back(nullptr);
+        int argc = (int) argv.size() - 1;
+        DStaticArgumentParser<StaticVerboseOption, StaticQuietOption, StaticOutputOption> staticParser(argc, argv.data());
+        DParseResult staticResult = staticParser.Parse();
+        std::string staticText = std::to_string((int) staticResult) + " " + std::to_string(staticParser.WasSet<StaticVerboseOption>()) + std::to_string(staticParser.WasSet<StaticQuietOption>()) + std::to_string(staticParser.WasSet<StaticOutputOption>()) + " " + std::string(staticParser.GetValue<StaticOutputOption>());
+        DArgumentParser parser(argc, argv.data());
+        DArgumentOption verbose({'v'}, {"verbose"}), quiet({'q'}, {"quiet"}), output(DArgumentOptionType::InputOption, {'o'}, {"out", "output"});
+        parser.AddArgumentOption({&verbose, &quiet, &output});
+        DParseResult result = parser.Parse();
+        std::string text = std::to_string((int) result) + " " + std::to_string(verbose.WasSet()) + std::to_string(quiet.WasSet()) + std::to_string(output.WasSet()) + " " + std::string(output.GetValueView());
+        //on success both keep every positional argument, on failure only the ones before the error
+        if (result == DParseResult::ParseSuccessful) {
+            for (auto argument: staticParser.GetPositionalArguments())
+                staticText.append(" ").append(argument);
+            for (auto argument: parser.GetPositionalArgumentViews())
+                text.append(" ").append(argument);
+        }
+        //DArgumentParser also suggests the closest commands after the error
+        bool sameError = parser.ErrorText().rfind(staticParser.ErrorText(), 0) == 0 && staticParser.ErrorText().empty() == parser.ErrorText().empty();
+        if ((staticText != text || !sameError) && mismatches++ == 0)
+            std::fprintf(stderr, "first static parser mismatch:\n  static: %s %s\n  parser: %s %s\n", staticText.c_str(), staticParser.ErrorText().c_str(), text.c_str(), parser.ErrorText().c_str());
+    }
+    check(mismatches == 0, "DStaticArgumentParser parses and reports errors like DArgumentParser");
+    check(DArgumentParser::FormatErrorText(DParseResult::InvalidOption, 'z') == "Option -z is invalid" && DArgumentParser::FormatErrorText(DParseResult::NoValueWasPassedToOption, "out") == "Option --out takes a value but none was passed.", "error texts are formatted without a parser");
+}
+
+/**
+ * Converts valid and invalid values of every value type, checking the converted values and that a failed conversion leaves none behind.
+ */
+void checkValueConversion() {
+    struct Conversion {
+        DArgumentValueType type;
+        const char *value;
+        bool valid;
+        double expected;
+    };
+    const Conversion conversions[] = {
+            {DArgumentValueType::Integer,       "42",                  true,  42},
+            {DArgumentValueType::Integer,       "-42",                 true,  -42},
+            {DArgumentValueType::Integer,       "+5",                  true,  5},
+            {DArgumentValueType::Integer,       "9223372036854775808", false, 0},
+            {DArgumentValueType::Integer,       "4x",                  false, 0},
+            {DArgumentValueType::Integer,       "0x10",                false, 0},
+            {DArgumentValueType::Integer,       "+-1",                 false, 0},
+            {DArgumentValueType::FloatingPoint, "3.5",                 true,  3.5},
+            {DArgumentValueType::FloatingPoint, "1e-3",                true,  1e-3},
+            {DArgumentValueType::FloatingPoint, "1.5x",                false, 0},
+            {DArgumentValueType::FloatingPoint, "abc",                 false, 0},
+            {DArgumentValueType::Boolean,       "TRUE",                true,  1},
+            {DArgumentValueType::Boolean,       "Yes",                 true,  1},
+            {DArgumentValueType::Boolean,       "off",                 true,  0},
+            {DArgumentValueType::Boolean,       "maybe",               false, 0},
+            {DArgumentValueType::Duration,      "1.5s",                true,  1.5e9},
+            {DArgumentValueType::Duration,      "250ms",               true,  250e6},
+            {DArgumentValueType::Duration,      "2",                   true,  2e9},
+            {DArgumentValueType::Duration,      "10us",                true,  10e3},
+            {DArgumentValueType::Duration,      "3m",                  true,  180e9},
+            {DArgumentValueType::Duration,      "1d",                  true,  86400e9},
+            {DArgumentValueType::Duration,      "1x",                  false, 0},
+            {DArgumentValueType::Duration,      "-1s",                 false, 0},
+            {DArgumentValueType::ByteSize,      "64K",                 true,  65536},
+            {DArgumentValueType::ByteSize,      "1KiB",                true,  1024},
+            {DArgumentValueType::ByteSize,      "1kB",                 true,  1000},
+            {DArgumentValueType::ByteSize,      "1.5GB",               true,  1.5e9},
+            {DArgumentValueType::ByteSize,      "1T",                  true,  1099511627776.0},
+            {DArgumentValueType::ByteSize,      "10B",                 true,  10},
+            {DArgumentValueType::ByteSize,      "1KB",                 false, 0},
+            {DArgumentValueType::ByteSize,      "1k",                  false, 0},
+            {DArgumentValueType::ByteSize,      "-1K",                 false, 0},
+            {DArgumentValueType::ByteSize,      "20000000T",           false, 0}};
+    char *argv[] = {(char *) "check", nullptr};
+    int mismatches = 0;
+    for (const auto &conversion: conversions) {
+        DArgumentParser parser(1, argv);
+        DArgumentOption option(DArgumentOptionType::InputOption, {'x'}, {"value"});
+        option.SetValueType(conversion.type);
+        parser.AddArgumentOption(option);
+        DParseResult result = parser.ParseCommandString(std::string("--value=") + conversion.value);
+        double converted = 0;
+        switch (conversion.type) {
+            case DArgumentValueType::Integer:
+                converted = (double) option.GetIntegerValue();
+                break;
+            case DArgumentValueType::FloatingPoint:
+                converted = option.GetFloatingPointValue();
+                break;
+            case DArgumentValueType::Boolean:
+                converted = option.GetBooleanValue();
+                break;
+            case DArgumentValueType::Duration:
+                converted = (double) option.GetDurationValue().count();
+                break;
+            default:
+                converted = (double) option.GetByteSizeValue();
+                break;
+        }
+        bool matches = (result == DParseResult::ParseSuccessful) == conversion.valid && converted == conversion.expected;
+        if (!conversion.valid)
+            matches &= result == DParseResult::InvalidValue && parser.ErrorText() == "Option --value received a value in an invalid format";
+        if (!matches && mismatches++ == 0)
+            std::fprintf(stderr, "first conversion mismatch: %s returned %d and %g\n", conversion.value, (int) result, converted);
+    }
+    check(mismatches == 0, "values are converted to their type, invalid ones fail without leaving a value behind");
+}
+
+/**
+ * Adds, removes and re-adds options with generated commands, comparing what every command resolves to with the options registered at the time, then checks the collisions and the removal of an option whose commands changed while it was added.
+ */
+void checkCommandIndex() {
+    std::deque<DArgumentOption> options;
+    for (int index = 0; index < 64; index++)
+        options.emplace_back(std::set<char>{(char) ('A' + index % 58)}, std::set<std::string>{"option" + std::to_string(index)});
+    char *argv[] = {(char *) "check", nullptr};
+    DArgumentParser parser(1, argv);
+    std::vector<bool> registered(options.size());
+    unsigned long long state = 0x2545F4914F6CDD1Dull;
+    auto next = [&state](unsigned bound) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return (unsigned) ((state >> 33) % bound);
+    };
+    int mismatches = 0;
+    for (int round = 0; round < 2000; round++) {
+        size_t index = next((unsigned) options.size());
+        if (registered[index]) {
+            mismatches += !parser.RemoveArgumentOption(options[index]);
+            registered[index] = false;
+        } else {
+            //the short commands repeat every 58 options, so only one option of each group can be added at a time
+            bool collides = false;
+            for (size_t other = index % 58; other < options.size(); other += 58)
+                collides |= registered[other];
+            mismatches += parser.AddArgumentOption(options[index]) == collides;
+            registered[index] = !collides;
+        }
+        size_t queried = next((unsigned) options.size());
+        std::string command = "--option" + std::to_string(queried);
+        DParseResult result = parser.ParseCommandString(command);
+        mismatches += (result == DParseResult::ParseSuccessful) != registered[queried];
+        mismatches += parser.WasSet(command.substr(2)) != (int) registered[queried];
+        mismatches += parser.WasSet((char) ('A' + queried % 58)) != (int) registered[queried];
+    }
+    check(mismatches == 0, "commands resolve to the options registered at the time");
+
+    DArgumentOption alpha({'a'}, {"alpha"}), beta({'b'}, {"beta"}), gamma({'c'}, {"gamma"}), clash({'x'}, {"beta"});
+    DArgumentParser indexParser(1, argv);
+    check(indexParser.AddArgumentOption({&alpha, &beta}), "options with unique commands are added");
+    check(!indexParser.AddArgumentOption({&gamma, &clash}) && indexParser.RegistrationErrorText().find("beta") != std::string::npos, "a batch with a taken command is rejected, naming the command");
+    check(indexParser.ParseCommandString("-c") == DParseResult::InvalidOption && indexParser.ParseCommandString("-x") == DParseResult::InvalidOption, "a rejected batch leaves none of its options behind");
+    alpha.ClearLongCommands();
+    alpha.AddLongCommand("renamed");
+    check(indexParser.RemoveArgumentOption(alpha) && indexParser.ParseCommandString("--alpha") == DParseResult::InvalidOption && indexParser.ParseCommandString("-a") == DParseResult::InvalidOption, "removing an option removes the commands it was indexed with");
+    DArgumentOption newAlpha({'a'}, {"alpha"});
+    bool added = indexParser.AddArgumentOption(newAlpha);
+    check(added && indexParser.ParseCommandString("--alpha -b") == DParseResult::ParseSuccessful && newAlpha.WasSet() && beta.WasSet() && !alpha.WasSet(), "the commands of a removed option can be added again");
+}
+
+/**
+ * Registers generated batches of options, some colliding with each other or with the options added before, comparing the outcome with a pairwise comparison of their commands, and checks the text of every registration error.
+ */
+void checkBatchRegistration() {
+    const char *longPool[] = {"alpha", "beta", "gamma", "delta", "epsilon", "zeta", "eta", "theta", "iota", "kappa", "lambda", "mu"};
+    const char *environmentPool[] = {"", "", "", "CHECK_A", "CHECK_B"};
+    std::deque<DArgumentOption> options;
+    unsigned long long state = 0xBF58476D1CE4E5B9ull;
+    auto next = [&state](unsigned bound) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return (unsigned) ((state >> 33) % bound);
+    };
+    //there's no getter for the environment variable, so the one each option was given is kept here
+    std::unordered_map<const DArgumentOption *, std::string> environments;
+    auto collides = [&environments](const DArgumentOption *first, const DArgumentOption *second) {
+        for (auto command: first->ShortCommands())
+            if (second->ShortCommands().count(command))
+                return true;
+        for (const auto &command: first->LongCommands())
+            if (second->LongCommands().count(command))
+                return true;
+        return !environments[first].empty() && environments[first] == environments[second];
+    };
+    char *argv[] = {(char *) "check", nullptr};
+    DArgumentParser parser(1, argv);
+    std::vector<const DArgumentOption *> added;
+    int mismatches = 0;
+    for (int round = 0; round < 300; round++) {
+        std::unordered_set<DArgumentOption *> batch;
+        for (unsigned count = next(5) + 1; count > 0; count--) {
+            if (!added.empty() && next(10) == 0) {
+                batch.insert(const_cast<DArgumentOption *>(added[next((unsigned) added.size())]));
+                continue;
+            }
+            DArgumentOption &option = options.emplace_back();
+            if (next(3) != 0)
+                option.AddShortCommand((char) ('a' + next(26)));
+            if (next(3) != 0)
+                option.AddLongCommand(longPool[next(12)] + std::to_string(next(40)));
+            environments[&option] = environmentPool[next(5)];
+            option.SetEnvironmentVariable(environments[&option]);
+            batch.insert(&option);
+        }
+        bool expected = true;
+        for (auto option: batch) {
+            expected &= !(option->ShortCommands().empty() && option->LongCommands().empty());
+            expected &= std::find(added.begin(), added.end(), option) == added.end();
+            for (auto other: added)
+                expected &= !collides(option, other);
+            for (auto other: batch)
+                expected &= other == option || !collides(option, other);
+        }
+        std::unordered_set<DArgumentOption *> batchCopy(batch);
+        bool result = parser.AddArgumentOption(std::move(batchCopy));
+        mismatches += result != expected || parser.RegistrationErrorText().empty() != result;
+        if (result)
+            added.insert(added.end(), batch.begin(), batch.end());
+        //a rejected batch adds nothing, the options added before still resolve to themselves
+        for (auto option: added)
+            for (const auto &command: option->LongCommands())
+                mismatches += parser.ParseCommandString("--" + command) != DParseResult::ParseSuccessful || !option->WasSet();
+        for (auto option: batch)
+            if (std::find(added.begin(), added.end(), option) == added.end())
+                for (const auto &command: option->LongCommands())
+                    mismatches += parser.ParseCommandString("--" + command) == DParseResult::ParseSuccessful && option->WasSet();
+    }
+    check(mismatches == 0, "a batch is added only if none of its commands collide, and a rejected batch adds nothing");
+
+    DArgumentParser errorParser(1, argv);
+    DArgumentOption verbose({'v'}, {"verbose"}), shortClash({'v'}, {"other"}), longClash({'x'}, {"verbose"}), noCommands;
+    DArgumentOption first({'a'}, {"first"}), second({'b'}, {"first"}), environment({'e'}, {"environment"}), environmentClash({'f'}, {"clash"});
+    environment.SetEnvironmentVariable("CHECK_A");
+    environmentClash.SetEnvironmentVariable("CHECK_A");
+    std::vector<std::string> errors;
+    errorParser.AddArgumentOption(verbose);
+    for (auto option: {&verbose, &shortClash, &longClash, &noCommands}) {
+        errorParser.AddArgumentOption(option);
+        errors.push_back(errorParser.RegistrationErrorText());
+    }
+    errorParser.AddArgumentOption({&first, &second});
+    errors.push_back(errorParser.RegistrationErrorText());
+    errorParser.AddArgumentOption({&environment, &environmentClash});
+    errors.push_back(errorParser.RegistrationErrorText());
+    bool environmentAdded = errorParser.AddArgumentOption(environment);
+    errors.push_back(errorParser.RegistrationErrorText());
+    const std::vector<std::string> expectedErrors{"Option was already added", "Command -v is already used by another option", "Command --verbose is already used by another option", "Option has no commands",
+                                                  "Command --first is used by more than one of the options being added", "Environment variable CHECK_A is used by more than one of the options being added", ""};
+    check(environmentAdded && errors == expectedErrors, "registration errors name the command that collided");
+}
+
+/**
+ * Parses generated long command prefixes with abbreviations enabled, comparing the option found or the ambiguity error with a search through every command.
+ */
+void checkAbbreviations() {
+    const std::vector<std::vector<std::string>> commands{{"verbose"}, {"version"}, {"output", "out"}, {"outline"}, {"quiet"}, {"query"}, {"q"}, {"v2"}};
+    std::deque<DArgumentOption> options;
+    for (const auto &optionCommands: commands)
+        options.emplace_back(DArgumentOptionType::InputOption, std::set<char>{}, std::set<std::string>(optionCommands.begin(), optionCommands.end()));
+    char *argv[] = {(char *) "check", nullptr};
+    DArgumentParser parser(1, argv);
+    for (auto &option: options)
+        parser.AddArgumentOption(option);
+    parser.SetLongCommandAbbreviation(true);
+    std::vector<const DArgumentOption *> schemaOptions;
+    for (const auto &option: options)
+        schemaOptions.push_back(&option);
+    DArgumentSchema schema(schemaOptions, false, true);
+    int mismatches = 0;
+    for (size_t index = 0; index < commands.size(); index++) {
+        for (const auto &command: commands[index]) {
+            for (size_t length = 1; length <= command.size(); length++) {
+                std::string prefix = command.substr(0, length);
+                //the reference: an exact match, otherwise every command starting with the prefix
+                std::vector<std::string> candidates;
+                std::set<size_t> owners;
+                int exact = -1;
+                for (size_t other = 0; other < commands.size(); other++) {
+                    for (const auto &otherCommand: commands[other]) {
+                        exact = otherCommand == prefix ? (int) other : exact;
+                        if (otherCommand.rfind(prefix, 0) == 0) {
+                            candidates.push_back(otherCommand);
+                            owners.insert(other);
+                        }
+                    }
+                }
+                std::sort(candidates.begin(), candidates.end());
+                std::string expected;
+                if (exact != -1 || owners.size() == 1) {
+                    expected = "0 " + std::to_string(exact != -1 ? exact : (int) *owners.begin());
+                } else {
+                    expected = "7 Option --" + prefix + " is ambiguous, it could be";
+                    for (size_t candidate = 0; candidate < candidates.size(); candidate++)
+                        expected += (candidate == 0 ? " --" : ", --") + candidates[candidate];
+                }
+                std::string argument = "--" + prefix + "=value";
+                char *prefixArgv[] = {(char *) "check", argument.data(), nullptr};
+                DParseResult result = parser.ParseCommandString(argument);
+                DParseOutcome outcome = schema.Parse(2, prefixArgv);
+                std::string found = std::to_string((int) result) + " ", outcomeFound = std::to_string((int) outcome.Result()) + " ";
+                if (result == DParseResult::ParseSuccessful) {
+                    for (size_t option = 0; option < options.size(); option++) {
+                        if (options[option].WasSet() && options[option].GetValue() == "value")
+                            found += std::to_string(option);
+                        if (outcome.WasSet(options[option]))
+                            outcomeFound += std::to_string(option);
+                    }
+                } else {
+                    found += parser.ErrorText();
+                    outcomeFound += outcome.ErrorText();
+                    std::vector<std::string> reported(parser.GetAmbiguousCandidates().begin(), parser.GetAmbiguousCandidates().end());
+                    found += reported == candidates ? "" : " (wrong candidates)";
+                }
+                if ((found != expected || outcomeFound != expected) && mismatches++ == 0)
+                    std::fprintf(stderr, "first abbreviation mismatch: --%s\n  expected: %s\n  parser: %s\n  schema: %s\n", prefix.c_str(), expected.c_str(), found.c_str(), outcomeFound.c_str());
+            }
+        }
+    }
+    check(mismatches == 0, "abbreviations resolve to the single option they belong to, or fail listing every candidate");
+    parser.SetLongCommandAbbreviation(false);
+    check(parser.ParseCommandString("--verb=value") == DParseResult::InvalidOption && parser.GetAmbiguousCandidates().empty(), "abbreviations are rejected unless enabled");
+    check(parser.ParseCommandString("--verbose=value") == DParseResult::ParseSuccessful && parser.GetAmbiguousCandidates().empty(), "ambiguous candidates are cleared by the next parse");
+}
+
+/**
+ * Edits the arguments passed on creation step by step, checking the errors of incomplete and invalid arguments, undoing past the start, truncating past the end, and that edits outlive the strings they were passed.
+ */
+void checkArgumentEditingErrors() {
+    char *argv[] = {(char *) "check", (char *) "-v", (char *) "--num", (char *) "3", nullptr};
+    char *noVariables[] = {nullptr};
+    DArgumentParser parser(4, argv);
+    EditingSchema schema(parser, noVariables, "");
+    DParseResult result = parser.BeginArgumentEditing();
+    check(result == DParseResult::ParseSuccessful && parser.EditedArgumentCount() == 3 && schema.verbose.WasSet() && schema.number.GetIntegerValue() == 3, "editing starts from the arguments passed on creation");
+    {
+        std::string argument = "--output";
+        result = parser.AppendArgument(argument);
+        check(result == DParseResult::NoValueWasPassedToOption && parser.ErrorText() == "Option --output takes a value but none was passed.", "an option still waiting for its value is reported");
+        argument = "edited";
+        result = parser.AppendArgument(argument);
+        argument.assign(argument.size(), 'x');
+    }
+    check(result == DParseResult::ParseSuccessful && parser.ErrorText().empty() && schema.output.GetValue() == "edited", "appending the value completes the option, and the edited values are copies");
+    result = parser.ReplaceLastArgument("--bogus");
+    check(result == DParseResult::NoValueWasPassedToOption && !schema.output.WasSet(), "replacing the value takes the option back to waiting for it");
+    result = parser.UndoArgumentEdit();
+    check(result == DParseResult::ParseSuccessful && parser.ErrorText().empty() && schema.output.GetValue() == "edited" && parser.EditedArgumentCount() == 5, "undoing a replace restores the argument and the results");
+    result = parser.AppendArgument("--num=many");
+    check(result == DParseResult::InvalidValue && parser.ErrorText() == "Option --num received a value in an invalid format" && parser.EditedArgumentCount() == 6, "an invalid value is reported");
+    result = parser.UndoArgumentEdit();
+    check(result == DParseResult::ParseSuccessful && parser.ErrorText().empty() && schema.number.GetIntegerValue() == 3, "undoing an invalid value restores the value before it");
+    result = parser.TruncateArguments(100);
+    check(result == DParseResult::ParseSuccessful && parser.EditedArgumentCount() == 5, "truncating past the end leaves the arguments alone");
+    result = parser.TruncateArguments(0);
+    check(result == DParseResult::ParseSuccessful && parser.EditedArgumentCount() == 0 && !schema.verbose.WasSet() && !schema.number.WasSet(), "truncating every argument unsets every option");
+    for (int undo = 0; undo < 10; undo++)
+        result = parser.UndoArgumentEdit();
+    check(result == DParseResult::ParseSuccessful && parser.EditedArgumentCount() == 3 && schema.verbose.WasSet() && schema.number.GetIntegerValue() == 3, "undoing past the first edit returns to the arguments passed on creation");
+    result = parser.Parse();
+    result = parser.AppendArgument("-q");
+    check(result == DParseResult::ParseSuccessful && parser.EditedArgumentCount() == 4 && schema.quiet.WasSet() && schema.verbose.WasSet(), "an edit after another parse starts the editing again");
+}
+
+/**
+ * Parses generated argv vectors lazily, querying a few of the options, and compares them and the result of Validate with an eager Parse of the same argv, with the environment and the config file as fallbacks.
+ */
+void checkLazyParse() {
+    std::string path = writeCheckFile("num = 7\nquiet\ninclude = configinc\n");
+    check(!path.empty(), "lazy parse check writes its config file");
+    char *environment[] = {(char *) "CHECK_VERBOSE=1", (char *) "CHECK_OUTPUT=fromenv", (char *) "CHECK_INCLUDE=envinc", nullptr};
+    char *invalidEnvironment[] = {(char *) "CHECK_NUM=many", nullptr};
+    const char *tokens[] = {"a", "-v", "-vo", "-o", "x", "--num", "3", "--num=4", "--num=four", "-I", "inc", "--include=two", "--output=y", "-q", "--bogus", "-", "-n", "-qv"};
+    auto describeOption = [](const DArgumentOption &option) {
+        std::string text = std::to_string(option.WasSet()) + " " + std::to_string((int) option.GetValueSource()) + " " + std::to_string(option.GetIntegerValue());
+        for (auto value: option.GetValues())
+            text.append(" ").append(value);
+        return text;
+    };
+    unsigned long long state = 0x5851F42D4C957F2Dull;
+    auto next = [&state](unsigned bound) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return (unsigned) ((state >> 33) % bound);
+    };
+    int mismatches = 0;
+    for (int round = 0; round < 500; round++) {
+        char **variables = round % 4 == 0 ? invalidEnvironment : environment;
+        std::vector<char *> argv{(char *) "check"};
+        for (unsigned count = next(7); count > 0; count--)
+            argv.push_back((char *) tokens[next(sizeof(tokens) / sizeof(tokens[0]))]);
+        argv.push_back(nullptr);
+        int argc = (int) argv.size() - 1;
+        DArgumentParser eagerParser(argc, argv.data());
+        EditingSchema eager(eagerParser, variables, path.c_str());
+        DParseResult eagerResult = eagerParser.Parse();
+        DArgumentParser lazyParser(argc, argv.data());
+        EditingSchema lazy(lazyParser, variables, path.c_str());
+        mismatches += lazyParser.ParseLazily() != DParseResult::ParseSuccessful;
+        //until the parse fails, the queried options hold what Parse sets
+        const DArgumentOption *eagerOptions[] = {&eager.verbose, &eager.quiet, &eager.output, &eager.include, &eager.number};
+        DArgumentOption *lazyOptions[] = {&lazy.verbose, &lazy.quiet, &lazy.output, &lazy.include, &lazy.number};
+        for (int option = 0; option < 5; option++) {
+            if (next(2) == 0)
+                continue;
+            const DArgumentOption &queried = lazyParser.Get(*lazyOptions[option]);
+            if (eagerResult == DParseResult::ParseSuccessful)
+                mismatches += &queried != lazyOptions[option] || describeOption(queried) != describeOption(*eagerOptions[option]);
+        }
+        DParseResult validateResult = lazyParser.Validate();
+        if ((validateResult != eagerResult || lazy.describe(lazyParser, validateResult) != eager.describe(eagerParser, eagerResult)) && mismatches++ == 0)
+            std::fprintf(stderr, "first lazy parse mismatch:\n  lazy: %s\n  eager: %s\n", lazy.describe(lazyParser, validateResult).c_str(), eager.describe(eagerParser, eagerResult).c_str());
+        mismatches += lazyParser.Validate() != validateResult;
+    }
+    check(mismatches == 0, "queried options and Validate match Parse");
+
+    char *argv[] = {(char *) "check", (char *) "-v", (char *) "--bogus", (char *) "-n", (char *) "5", nullptr};
+    DArgumentParser parser(5, argv);
+    EditingSchema schema(parser, environment, path.c_str());
+    bool lazilyParsed = parser.ParseLazily() == DParseResult::ParseSuccessful;
+    check(lazilyParsed && !schema.verbose.WasSet() && parser.WasSet('v') && schema.verbose.WasSet() && schema.verbose.GetValueSource() == DValueSource::CommandLine, "an option is only set once it's queried through the parser");
+    check(parser.Get("num").GetIntegerValue() == 5 && parser.Get('o').GetValue() == "fromenv" && parser.ErrorText().empty(), "lazily queried options are set from valid commands and fallbacks before the error is found");
+    check(parser.Validate() == DParseResult::InvalidOption && parser.ErrorText().rfind("Option --bogus is invalid", 0) == 0, "Validate reports the error of the lazy parse");
+    unlink(path.c_str());
+}
+
+/**
+ * Edits an argument list with generated appends, replacements, truncations and undos, comparing the result of every edit with a new parser calling Parse on the same arguments.
+ */
+void checkArgumentEditing() {
+    char path[] = "/tmp/DArgumentParserChecksXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        check(false, "argument editing check creates its config file");
+        return;
+    }
+    const std::string contents = "num = 7\nquiet\ninclude = configinc\n";
+    bool written = write(fd, contents.data(), contents.size()) == (ssize_t) contents.size();
+    close(fd);
+    check(written, "argument editing check writes its config file");
+    char *environment[] = {(char *) "PATH=/usr/bin", (char *) "CHECK_VERBOSE=1", (char *) "CHECK_OUTPUT=fromenv", (char *) "CHECK_INCLUDE=envinc", nullptr};
+    //an invalid variable, so the edits also go through a failing fallback source
+    char *invalidEnvironment[] = {(char *) "CHECK_OUTPUT=fromenv", (char *) "CHECK_NUM=many", nullptr};
+    const char *tokens[] = {"a", "-v", "-vo", "-o", "x", "--num", "3", "--num=4", "-I", "inc", "--include=two", "--output=y", "-q", "--bogus", "--verbos", "-", "-n", "-qv"};
+    auto parsedFresh = [&](const std::vector<std::string> &arguments, char **variables) {
+        std::vector<char *> argv{(char *) "check"};
+        for (const auto &argument: arguments)
+            argv.push_back((char *) argument.c_str());
+        argv.push_back(nullptr);
+        DArgumentParser parser((int) argv.size() - 1, argv.data());
+        EditingSchema schema(parser, variables, path);
+        return schema.describe(parser, parser.Parse());
+    };
+    unsigned long long state = 0x9E3779B97F4A7C15ull;
+    auto next = [&state](unsigned bound) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return (unsigned) ((state >> 33) % bound);
+    };
+    int mismatches = 0;
+    for (int round = 0; round < 400; round++) {
+        char **variables = round % 2 == 0 ? environment : invalidEnvironment;
+        char *argv[] = {(char *) "check", nullptr};
+        DArgumentParser parser(1, argv);
+        EditingSchema schema(parser, variables, path);
+        std::vector<std::string> arguments;
+        std::vector<std::vector<std::string>> undoable;
+        DParseResult result = parser.BeginArgumentEditing();
+        for (int edit = 0; edit < 24; edit++) {
+            unsigned kind = next(8);
+            if (kind == 7) {
+                result = parser.UndoArgumentEdit();
+                if (!undoable.empty()) {
+                    arguments = undoable.back();
+                    undoable.pop_back();
+                }
+            } else {
+                undoable.push_back(arguments);
+                if (kind == 6) {
+                    size_t count = next((unsigned) arguments.size() + 1);
+                    result = parser.TruncateArguments(count);
+                    arguments.resize(count);
+                } else if (kind == 5) {
+                    std::string token = tokens[next(sizeof(tokens) / sizeof(tokens[0]))];
+                    result = parser.ReplaceLastArgument(token);
+                    if (arguments.empty())
+                        arguments.push_back(token);
+                    else
+                        arguments.back() = token;
+                } else {
+                    std::string token = tokens[next(sizeof(tokens) / sizeof(tokens[0]))];
+                    result = parser.AppendArgument(token);
+                    arguments.push_back(token);
+                }
+            }
+            if (schema.describe(parser, result) != parsedFresh(arguments, variables) && mismatches++ == 0) {
+                std::string command;
+                for (const auto &argument: arguments)
+                    command.append(" ").append(argument);
+                std::fprintf(stderr, "first edit mismatch:%s\n  edited: %s\n  parsed: %s\n", command.c_str(), schema.describe(parser, result).c_str(), parsedFresh(arguments, variables).c_str());
+            }
+        }
+    }
+    check(mismatches == 0, "argument edits return what Parse returns");
+    unlink(path);
+}
+
+/**
+ * Loads valid, malformed and missing config files, checks that argv beats the environment which beats the config file, and that reloading an unchanged file still checks its keys against the current options.
+ */
+void checkConfigFile() {
+    std::string path = writeCheckFile("# comment\n[section]\nnum = 7\nquiet\noutput = \"  spaced \"\n");
+    std::string malformedPath = writeCheckFile("num = 7\n= 3\n");
+    std::string unknownPath = writeCheckFile("num = 7\nbogus = 1\n");
+    check(!path.empty() && !malformedPath.empty() && !unknownPath.empty(), "config file check writes its files");
+    char *noVariables[] = {nullptr};
+    char *variables[] = {(char *) "CHECK_NUM=5", nullptr};
+    char *argv[] = {(char *) "check", (char *) "--num=3", nullptr};
+    auto parsedNumber = [&](int argc, char **variables) {
+        DArgumentParser parser(argc, argv);
+        EditingSchema schema(parser, variables, path.c_str());
+        DParseResult result = parser.Parse();
+        return std::to_string((int) result) + " " + std::to_string(schema.number.GetIntegerValue()) + " " + std::to_string((int) schema.number.GetValueSource());
+    };
+    check(parsedNumber(1, noVariables) == "0 7 3", "an option set only in the config file takes its value");
+    check(parsedNumber(1, variables) == "0 5 2", "the environment takes precedence over the config file");
+    check(parsedNumber(2, variables) == "0 3 1", "argv takes precedence over the environment and the config file");
+
+    DArgumentParser parser(1, argv);
+    EditingSchema schema(parser, noVariables, path.c_str());
+    bool parsed = parser.Parse() == DParseResult::ParseSuccessful;
+    check(parsed && schema.quiet.WasSet() && schema.quiet.GetValueSource() == DValueSource::ConfigFile && schema.output.GetValue() == "  spaced ", "config entries without a value and quoted values are read");
+    check(parser.LoadConfigFile(malformedPath) == DParseResult::InvalidConfigFile && parser.ErrorText().find("line 2") != std::string::npos, "a malformed config line is reported with its number");
+    check(parser.LoadConfigFile(unknownPath) == DParseResult::InvalidOption && parser.ErrorText().find("bogus") != std::string::npos, "an unknown config key is reported");
+    check(parser.LoadConfigFile("/nonexistent/DArgumentParserChecks") == DParseResult::InvalidConfigFile, "a missing config file is reported");
+    parsed = parser.Parse() == DParseResult::ParseSuccessful;
+    check(parsed && schema.number.GetIntegerValue() == 7, "the config file loaded before stays in use after failed loads");
+    check(parser.LoadConfigFile(path) == DParseResult::ParseSuccessful, "reloading an unchanged config file succeeds");
+    parser.RemoveArgumentOption(schema.number);
+    check(parser.LoadConfigFile(path) == DParseResult::InvalidOption && parser.ErrorText().find("num") != std::string::npos, "reloading an unchanged config file checks its keys against the current options");
+    parser.ClearConfigFile();
+    parsed = parser.Parse() == DParseResult::ParseSuccessful;
+    check(parsed && !schema.quiet.WasSet(), "a cleared config file isn't applied");
+    for (const auto &file: {path, malformedPath, unknownPath})
+        unlink(file.c_str());
+}
+
+/**
+ * Parses with environment variables for every kind of option, including malformed, empty, false and invalid ones, checking the values, their source and the errors.
+ */
+void checkEnvironment() {
+    std::string path = writeCheckFile("quiet\nnum = 7\n");
+    check(!path.empty(), "environment check writes its config file");
+    char *argv[] = {(char *) "check", (char *) "-o", (char *) "fromargv", nullptr};
+    auto parsed = [&](int argc, std::vector<const char *> variables) {
+        variables.push_back(nullptr);
+        DArgumentParser parser(argc, argv);
+        EditingSchema schema(parser, (char **) variables.data(), path.c_str());
+        //variables are indexed when the option is added
+        parser.RemoveArgumentOption(schema.quiet);
+        schema.quiet.SetEnvironmentVariable("CHECK_QUIET");
+        parser.AddArgumentOption(schema.quiet);
+        DParseResult result = parser.Parse();
+        return schema.describe(parser, result);
+    };
+    //the fields are the result and error, then the set count, source, integer value and values of verbose, quiet, output, include and num
+    check(parsed(1, {"CHECK_OUTPUT=fromenv", "CHECK_NUM=5", "CHECK_INCLUDE=envinc", "CHECK_VERBOSE=yes"}) == "0  | 1 2 0 | 1 3 0 | 1 2 0 fromenv | 1 2 0 envinc | 1 2 5 5", "options are set from their environment variables");
+    check(parsed(3, {"CHECK_OUTPUT=fromenv"}) == "0  | 0 0 0 | 1 3 0 | 1 1 0 fromargv | 0 0 0 | 1 3 7 7", "argv takes precedence over the environment");
+    check(parsed(1, {"CHECK_VERBOSE=off", "CHECK_QUIET=0"}) == "0  | 0 2 0 | 0 2 0 | 0 0 0 | 0 0 0 | 1 3 7 7", "a false variable leaves the option unset, even if the config file sets it");
+    check(parsed(1, {"CHECK_OUTPUT=", "CHECK_VERBOSE", "OTHER=1", "=1", "CHECK_NUM_OTHER=1"}) == "0  | 0 0 0 | 1 3 0 | 0 0 0 | 0 0 0 | 1 3 7 7", "empty, malformed and unrelated variables are ignored");
+    check(parsed(1, {"CHECK_NUM=many"}).rfind("6 Environment variable CHECK_NUM has a value in an invalid format", 0) == 0, "a variable that can't be converted fails the parse");
+    check(parsed(1, {"CHECK_VERBOSE=maybe"}).rfind("6 Environment variable CHECK_VERBOSE has a value in an invalid format", 0) == 0, "a variable that isn't a boolean fails the parse for options that don't take a value");
+    check(parsed(1, {"CHECK_NUM=1", "CHECK_NUM=2"}).find("| 1 2 1 1") != std::string::npos, "the first of repeated variables is used");
+
+    char *noArguments[] = {(char *) "check", nullptr};
+    DArgumentParser parser(1, noArguments);
+    DArgumentOption output(DArgumentOptionType::InputOption, {'o'}, {"output"});
+    output.SetEnvironmentVariable("CHECK_OUTPUT");
+    parser.AddArgumentOption(output);
+    char *variables[] = {(char *) "CHECK_OUTPUT=fromenv", nullptr};
+    parser.SetEnvironment(variables);
+    bool parsedOutput = parser.Parse() == DParseResult::ParseSuccessful && output.GetValue() == "fromenv";
+    parser.RemoveArgumentOption(output);
+    output.SetEnvironmentVariable("");
+    parser.AddArgumentOption(output);
+    check(parsedOutput && parser.Parse() == DParseResult::ParseSuccessful && !output.WasSet() && output.GetValueSource() == DValueSource::NotSet, "an empty variable name removes the option's variable");
+
+    setenv("CHECK_SCHEMA_OUTPUT", "fromenviron", 1);
+    output.SetEnvironmentVariable("CHECK_SCHEMA_OUTPUT");
+    DArgumentSchema schema({&output});
+    DParseOutcome outcome = schema.Parse(1, noArguments);
+    unsetenv("CHECK_SCHEMA_OUTPUT");
+    check(outcome.Result() == DParseResult::ParseSuccessful && outcome.Get(output).GetValue() == "fromenviron" && outcome.Get(output).GetValueSource() == DValueSource::Environment, "a schema reads environ");
+    unlink(path.c_str());
+}
+
+/**
+ * Parses command lines with and without subcommands, checking that only the factory of the subcommand used is called (once), where the options and errors end up, and the invalid subcommand names.
+ */
+void checkSubcommands() {
+    DArgumentOption verbose({'v'}, {"verbose"}), release({'r'}, {"release"}), jobs(DArgumentOptionType::InputOption, {'j'}, {"jobs"});
+    int buildFactoryCalls = 0, testFactoryCalls = 0;
+    char *argv[] = {(char *) "check", nullptr};
+    DArgumentParser parser(1, argv);
+    parser.AddArgumentOption(verbose);
+    bool added = parser.AddSubcommand("build", "Builds the project.", [&](DArgumentParser &subcommand) {
+        buildFactoryCalls++;
+        subcommand.AddArgumentOption({&release, &jobs});
+    });
+    added &= parser.AddSubcommand("test", "Runs the tests.", [&](DArgumentParser &) { testFactoryCalls++; });
+    check(added && buildFactoryCalls == 0 && testFactoryCalls == 0, "subcommand factories aren't called when the subcommands are added");
+    DParseResult result = parser.ParseCommandString("-v build --release -j 4 target");
+    DArgumentParser *subcommandParser = parser.SubcommandParser();
+    check(result == DParseResult::ParseSuccessful && parser.SelectedSubcommand() == "build" && subcommandParser != nullptr && verbose.WasSet() && release.WasSet() && jobs.GetValue() == "4", "the options before a subcommand go to the parser and the ones after it to the subcommand");
+    check(subcommandParser != nullptr && subcommandParser->GetPositionalArguments() == std::vector<std::string>{"target"} && buildFactoryCalls == 1 && testFactoryCalls == 0, "only the factory of the selected subcommand is called");
+    result = parser.ParseCommandString("-v");
+    check(result == DParseResult::ParseSuccessful && parser.SelectedSubcommand().empty() && parser.SubcommandParser() == nullptr && release.WasSet() && jobs.GetValue() == "4", "the results of a subcommand stay valid until it's selected again");
+    result = parser.ParseCommandString("build -v");
+    check(result == DParseResult::InvalidOption && parser.ErrorText() == "Option -v is invalid" && parser.SubcommandParser()->ErrorText() == parser.ErrorText() && !verbose.WasSet() && !release.WasSet() && buildFactoryCalls == 1, "the options of the parser aren't accepted after a subcommand, its error is reported by both parsers");
+    result = parser.ParseCommandString("build --jobs");
+    check(result == DParseResult::NoValueWasPassedToOption && parser.ErrorText() == "Option --jobs takes a value but none was passed.", "a subcommand option without its value is reported");
+    result = parser.ParseCommandString("-v bogus build");
+    check(result == DParseResult::InvalidSubcommand && parser.ErrorText() == "Command bogus is invalid" && parser.SelectedSubcommand().empty() && parser.SubcommandParser() == nullptr, "a first positional argument that isn't a subcommand is reported");
+    result = parser.ParseCommandString("test a b");
+    check(result == DParseResult::ParseSuccessful && parser.SelectedSubcommand() == "test" && parser.SubcommandParser()->GetPositionalArgumentViews().size() == 2 && testFactoryCalls == 1, "a subcommand without options takes positional arguments");
+    std::vector<std::string> errors;
+    for (const char *name: {"", "a b", "-x", "@x", "build"}) {
+        if (!parser.AddSubcommand(name, "", [](DArgumentParser &) {}))
+            errors.push_back(parser.RegistrationErrorText());
+    }
+    const std::vector<std::string> expectedErrors{"Subcommand name \"\" is invalid", "Subcommand name \"a b\" is invalid", "Subcommand name \"-x\" is invalid", "Subcommand name \"@x\" is invalid", "Subcommand build was already added"};
+    check(errors == expectedErrors, "invalid and repeated subcommand names are rejected");
+}
+
+/**
+ * Runs __complete queries through WriteCompletions, including one for a subcommand, comparing the output with the expected candidates.
+ */
+void checkCompletions() {
+    DArgumentOption release({'r'}, {"release"}, "Builds with optimizations.");
+    auto completionsFor = [&release](std::vector<const char *> words) {
+        std::vector<char *> argv{(char *) "check", (char *) "__complete"};
+        for (auto word: words)
+            argv.push_back((char *) word);
+        argv.push_back(nullptr);
+        DArgumentParser parser((int) argv.size() - 1, argv.data());
+        DArgumentOption verbose({'v'}, {"verbose"}, "Prints more.");
+        DArgumentOption quiet({'q'}, {"quiet"});
+        DArgumentOption color(DArgumentOptionType::InputOption, {}, {"color"});
+        color.SetValueType(DArgumentValueType::Boolean);
+        parser.AddArgumentOption({&verbose, &quiet, &color});
+        parser.AddSubcommand("build", "Builds the project.", [&release](DArgumentParser &subcommand) { subcommand.AddArgumentOption(release); });
+        std::string output;
+        DStringHelpSink sink(output);
+        return parser.WriteCompletions(sink) ? output : "not a query";
+    };
+    check(completionsFor({"--ver"}) == "--verbose\tPrints more.\n", "long commands are completed from their prefix");
+    check(completionsFor({"-"}) == "-q\n-v\tPrints more.\n--color\n--quiet\n--verbose\tPrints more.\n", "a single minus sign completes every short and long command");
+    check(completionsFor({"-qv"}) == "-qv\n" && completionsFor({"-qx"}).empty(), "a cluster of short commands is only completed if every command exists");
+    check(completionsFor({"--color=f"}) == "--color=false\n" && completionsFor({"--color", ""}) == "true\nfalse\n", "boolean values are completed after the option");
+    check(completionsFor({"b"}) == "build\tBuilds the project.\n" && completionsFor({"input", "b"}).empty(), "subcommands are completed before the first positional argument");
+    check(completionsFor({"-v", "build", "--r"}) == "--release\tBuilds with optimizations.\n", "the options of a subcommand are completed after it");
+    char *argv[] = {(char *) "check", (char *) "--verbose", nullptr};
+    DArgumentParser parser(2, argv);
+    std::string output;
+    DStringHelpSink sink(output);
+    check(!parser.WriteCompletions(sink) && output.empty(), "an argv that isn't a completion query writes nothing");
+}
+
+/**
+ * Parses generated argv vectors with one schema from several threads at once, comparing every outcome with DArgumentParser, and checks how schemas are built from invalid options and from a parser.
+ */
+void checkSchema() {
+    DArgumentOption verbose({'v'}, {"verbose"}), quiet({'q'}, {"quiet"}), output(DArgumentOptionType::InputOption, {'o'}, {"output"}), number(DArgumentOptionType::InputOption, {'n'}, {"num"});
+    number.SetValueType(DArgumentValueType::Integer);
+    const char *tokens[] = {"-v", "-vo", "-o", "x", "--output=y", "--num", "3", "--num=many", "--bogus", "-q", "-qv", "pos", "--output"};
+    unsigned long long state = 0x94D049BB133111EBull;
+    auto next = [&state](unsigned bound) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return (unsigned) ((state >> 33) % bound);
+    };
+    std::vector<std::vector<char *>> argvs;
+    std::vector<std::string> expected;
+    for (int round = 0; round < 500; round++) {
+        std::vector<char *> &argv = argvs.emplace_back(1, (char *) "check");
+        for (unsigned count = next(6); count > 0; count--)
+            argv.push_back((char *) tokens[next(sizeof(tokens) / sizeof(tokens[0]))]);
+        argv.push_back(nullptr);
+        DArgumentParser parser((int) argv.size() - 1, argv.data());
+        parser.AddArgumentOption({&verbose, &quiet, &output, &number});
+        DParseResult result = parser.Parse();
+        std::string text = std::to_string((int) result) + " " + parser.ErrorText();
+        for (auto option: {&verbose, &quiet, &output, &number})
+            text += " " + std::to_string(option->WasSet()) + ":" + std::string(option->GetValueView()) + ":" + std::to_string(option->GetIntegerValue());
+        expected.push_back(text + " " + std::to_string(parser.GetPositionalArgumentViews().size()));
+    }
+    DArgumentSchema schema({&verbose, &quiet, &output, &number});
+    std::atomic<int> mismatches{0};
+    auto parseAll = [&]() {
+        for (size_t index = 0; index < argvs.size(); index++) {
+            DParseOutcome outcome = schema.Parse((int) argvs[index].size() - 1, argvs[index].data());
+            std::string text = std::to_string((int) outcome.Result()) + " " + outcome.ErrorText();
+            for (auto option: {&verbose, &quiet, &output, &number})
+                text += " " + std::to_string(outcome.WasSet(*option)) + ":" + std::string(outcome.Get(*option).GetValueView()) + ":" + std::to_string(outcome.Get(*option).GetIntegerValue());
+            if (text + " " + std::to_string(outcome.GetPositionalArgumentViews().size()) != expected[index])
+                mismatches++;
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < 4; thread++)
+        threads.emplace_back(parseAll);
+    for (auto &thread: threads)
+        thread.join();
+    check(mismatches == 0, "a schema shared by several threads parses like DArgumentParser");
+
+    char *first[] = {(char *) "check", (char *) "-v", (char *) "--output=a", nullptr};
+    char *second[] = {(char *) "check", (char *) "-q", (char *) "--bogus", nullptr};
+    DParseOutcome firstOutcome = schema.Parse(3, first), secondOutcome = schema.Parse(3, second);
+    check(firstOutcome.Result() == DParseResult::ParseSuccessful && firstOutcome.WasSet('v') && firstOutcome.Get("output").GetValue() == "a" && !firstOutcome.WasSet("quiet"), "an outcome keeps its own results");
+    check(secondOutcome.Result() == DParseResult::InvalidOption && secondOutcome.WasSet('q') && secondOutcome.ErrorText().rfind("Option --bogus is invalid", 0) == 0 && firstOutcome.ErrorText().empty(), "an outcome keeps its own error");
+    DArgumentOption stranger({'s'}, {"stranger"});
+    check(!firstOutcome.Get(stranger).WasSet() && !firstOutcome.Get('s').WasSet() && !firstOutcome.Get("nothing").WasSet(), "options that aren't part of the schema are never set");
+
+    DArgumentOption clash({'v'}, {"clash"}), noCommands;
+    DArgumentSchema invalidSchema({&verbose, &clash, &noCommands, &verbose, &quiet});
+    check(!invalidSchema.IsValid() && invalidSchema.OptionCount() == 2 && invalidSchema.IndexOf(clash) == -1 && invalidSchema.IndexOf(quiet) == 1, "invalid options are left out of a schema");
+    char *argv[] = {(char *) "check", nullptr};
+    DArgumentParser parser(1, argv);
+    DArgumentOption renamed({'r'}, {"renamed"});
+    parser.AddArgumentOption(renamed);
+    DArgumentSchema parserSchema = parser.CreateSchema();
+    parser.RemoveArgumentOption(renamed);
+    renamed.AddLongCommand("later");
+    char *later[] = {(char *) "check", (char *) "--later", nullptr}, *original[] = {(char *) "check", (char *) "--renamed", nullptr};
+    check(parserSchema.Parse(2, later).Result() == DParseResult::InvalidOption && parserSchema.Parse(2, original).WasSet(renamed), "a schema created from a parser isn't changed by later changes to it or to its options");
+}
+
+/**
+ * Round-trips a schema image through a file and memory, comparing the parses of generated argv vectors and the help and version texts with the parser it was created from, then loads truncated and corrupted images.
+ */
+void checkSchemaImage() {
+    char *noArguments[] = {(char *) "check", nullptr};
+    DArgumentParser parser(1, noArguments, "CheckApp", "2.1", "Checks schema images.");
+    DArgumentOption help(DArgumentOptionType::HelpOption, {'h'}, {"help"}, "Prints the help.");
+    DArgumentOption version(DArgumentOptionType::VersionOption, {}, {"version"}, "Prints the version.");
+    DArgumentOption verbose({'v'}, {"verbose"}, "Prints more.");
+    DArgumentOption output(DArgumentOptionType::InputOption, {'o'}, {"output", "out"}, "Where to write.");
+    DArgumentOption number(DArgumentOptionType::InputOption, {'n'}, {"num"}, "How many.");
+    DArgumentOption size(DArgumentOptionType::InputOption, {}, {"size"});
+    number.SetValueType(DArgumentValueType::Integer);
+    size.SetValueType(DArgumentValueType::ByteSize);
+    output.SetEnvironmentVariable("CHECK_IMAGE_OUTPUT");
+    parser.AddArgumentOption({&help, &version, &verbose, &output, &number, &size});
+    parser.AddPositionalArgument("file", "The file.");
+    parser.SetLongCommandAbbreviation(true);
+    std::string image = parser.CreateSchemaImage();
+    std::string path = writeCheckFile(image);
+    DMappedArgumentParser fileParser(1, noArguments);
+    check(!path.empty() && fileParser.Open(path) && fileParser.IsValid() && fileParser.OptionCount() == 6, "a schema image is opened from a file");
+    check(fileParser.HelpText() == parser.HelpText() && fileParser.VersionText() == parser.VersionText(), "a schema image keeps the help and version texts");
+
+    const char *tokens[] = {"-v", "-vo", "-o", "x", "--out=y", "--verb", "--ver", "--num", "3", "--num=many", "--size=64K", "--size=1k", "--bogus", "-h", "pos", "-", "-n"};
+    unsigned long long state = 0xA0761D6478BD642Full;
+    auto next = [&state](unsigned bound) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return (unsigned) ((state >> 33) % bound);
+    };
+    int mismatches = 0;
+    for (int round = 0; round < 500; round++) {
+        std::vector<char *> argv{(char *) "check"};
+        for (unsigned count = next(6); count > 0; count--)
+            argv.push_back((char *) tokens[next(sizeof(tokens) / sizeof(tokens[0]))]);
+        argv.push_back(nullptr);
+        int argc = (int) argv.size() - 1;
+        DArgumentParser roundParser(argc, argv.data());
+        roundParser.AddArgumentOption({&help, &version, &verbose, &output, &number, &size});
+        roundParser.SetLongCommandAbbreviation(true);
+        DParseResult result = roundParser.Parse();
+        DMappedArgumentParser mappedParser(argc, argv.data());
+        mappedParser.Load(image);
+        DParseResult mappedResult = mappedParser.Parse();
+        std::string text = std::to_string((int) result) + " " + roundParser.ErrorText(), mappedText = std::to_string((int) mappedResult) + " " + mappedParser.ErrorText();
+        for (const char *command: {"help", "version", "verbose", "output", "num", "size"}) {
+            const DArgumentOption &option = roundParser.Get(command), &mappedOption = mappedParser.Get(command);
+            text += " | " + std::to_string(option.WasSet()) + " " + std::string(option.GetValueView()) + " " + std::to_string(option.GetIntegerValue()) + " " + std::to_string(option.GetByteSizeValue());
+            mappedText += " | " + std::to_string(mappedOption.WasSet()) + " " + std::string(mappedOption.GetValueView()) + " " + std::to_string(mappedOption.GetIntegerValue()) + " " + std::to_string(mappedOption.GetByteSizeValue());
+        }
+        if (result == DParseResult::ParseSuccessful) {
+            text += " " + std::to_string(roundParser.GetPositionalArgumentViews().size());
+            mappedText += " " + std::to_string(mappedParser.GetPositionalArgumentViews().size());
+        }
+        if (text != mappedText && mismatches++ == 0)
+            std::fprintf(stderr, "first schema image mismatch:\n  parser: %s\n  image: %s\n", text.c_str(), mappedText.c_str());
+    }
+    check(mismatches == 0, "a schema image parses like the parser it was created from");
+
+    int acceptedPrefixes = 0;
+    for (size_t length = 0; length < image.size(); length++) {
+        DMappedArgumentParser truncatedParser(1, noArguments);
+        acceptedPrefixes += truncatedParser.Load(std::string_view(image.data(), length)) || truncatedParser.IsValid() || truncatedParser.OptionCount() != 0;
+    }
+    check(acceptedPrefixes == 0, "truncated schema images are rejected");
+    //corrupted images only need to be either rejected or parsed without reading out of bounds
+    std::string corrupted;
+    for (int round = 0; round < 2000; round++) {
+        corrupted = image;
+        for (unsigned flips = next(4) + 1; flips > 0; flips--)
+            corrupted[next((unsigned) corrupted.size())] ^= (char) (1 << next(8));
+        char *argv[] = {(char *) "check", (char *) "-v", (char *) "--output=x", (char *) "--nu", (char *) "4", (char *) "-z", nullptr};
+        DMappedArgumentParser corruptedParser(6, argv);
+        if (corruptedParser.Load(corrupted)) {
+            (void) corruptedParser.Parse();
+            (void) corruptedParser.HelpText();
+        }
+    }
+    DMappedArgumentParser missingParser(1, noArguments);
+    check(!missingParser.Open("/nonexistent/DArgumentParserChecks") && !missingParser.IsValid() && missingParser.OptionCount() == 0, "a missing schema image is rejected");
+    unlink(path.c_str());
+}
+
+/**
+ * Parses the same command lines with both buffer forms and the vector form of ParseBatch, on one and several threads, comparing every result with DArgumentSchema::Parse.
+ */
+void checkBatch() {
+    DArgumentOption verbose({'v'}, {"verbose"}), output(DArgumentOptionType::InputOption, {'o'}, {"output"}), number(DArgumentOptionType::InputOption, {'n'}, {"num"});
+    number.SetValueType(DArgumentValueType::Integer);
+    DArgumentSchema schema({&verbose, &output, &number});
+    const std::vector<std::string> lines{"app -v --output=a", "app\tfirst -o b  -n 4", "app --bogus", "-v", "app -n many", "", "app -vo"};
+    //enough copies of the lines for several chunks, so the threads share the work
+    std::string newlineBuffer, nulBuffer;
+    std::vector<std::vector<std::string_view>> commandLines;
+    for (int copy = 0; copy < 300; copy++) {
+        for (const auto &line: lines) {
+            newlineBuffer.append(line).push_back('\n');
+            nulBuffer.append(line).push_back('\0');
+        }
+    }
+    std::vector<std::vector<std::string>> tokens;
+    for (const auto &line: lines) {
+        std::vector<std::string> &lineTokens = tokens.emplace_back();
+        for (size_t start = 0, end; start < line.size(); start = end + 1) {
+            end = std::min(line.find_first_of(" \t", start), line.size());
+            if (end > start)
+                lineTokens.push_back(line.substr(start, end - start));
+        }
+    }
+    for (int copy = 0; copy < 300; copy++)
+        for (const auto &lineTokens: tokens)
+            commandLines.emplace_back(lineTokens.begin(), lineTokens.end());
+    auto describe = [&](const DBatchParseResults &batch, size_t line) {
+        std::string text = std::to_string((int) batch.Result(line));
+        for (int option = 0; option < 3; option++)
+            text.append(" ").append(std::to_string(batch.WasSet(line, option))).append(":").append(batch.GetValue(line, option));
+        return text;
+    };
+    auto describeParse = [&](const std::vector<std::string> &lineTokens) {
+        std::vector<char *> argv;
+        for (const auto &token: lineTokens)
+            argv.push_back((char *) token.c_str());
+        argv.push_back(nullptr);
+        DParseOutcome outcome = schema.Parse((int) argv.size() - 1, argv.data());
+        std::string text = std::to_string((int) outcome.Result());
+        for (auto option: {&verbose, &output, &number})
+            text.append(" ").append(std::to_string(outcome.Get(*option).WasSet() > 0)).append(":").append(outcome.Get(*option).WasSet() ? outcome.Get(*option).GetValueView() : "");
+        return text;
+    };
+    std::vector<DBatchParseResults> batches;
+    for (unsigned threadCount: {1u, 4u}) {
+        batches.push_back(schema.ParseBatch(newlineBuffer, '\n', threadCount));
+        batches.push_back(schema.ParseBatch(nulBuffer, '\0', threadCount));
+        batches.push_back(schema.ParseBatch(commandLines, threadCount));
+    }
+    int mismatches = 0;
+    for (const auto &batch: batches) {
+        if (batch.Size() != commandLines.size()) {
+            mismatches++;
+            continue;
+        }
+        for (size_t line = 0; line < batch.Size(); line++)
+            mismatches += describe(batch, line) != describeParse(tokens[line % tokens.size()]);
+    }
+    check(mismatches == 0, "batch parses of newline and NUL delimited buffers and of vectors match Parse on any number of threads");
+    check(batches[0].Result(2) == DParseResult::InvalidOption && batches[0].Result(4) == DParseResult::InvalidValue, "batch parses report failed lines");
+    check(!batches[0].WasSet(3, 0) && batches[0].Result(3) == DParseResult::ParseSuccessful, "the first argument of a batch line is the executable");
+    check(batches[0].GetValue(1, 1) == "b" && batches[0].GetValue(1, 2) == "4", "batch values are read from the buffer");
+}
+
+/**
+ * Expands nested, empty, missing and self-referencing response files, with quotes and escapes, through a parser and a schema.
+ */
+void checkResponseFiles() {
+    std::string emptyPath = writeCheckFile("");
+    std::string nestedPath = writeCheckFile("-I nested\\ arg\n@" + emptyPath + " positional\n");
+    std::string path = writeCheckFile("-v --output 'a b' @" + nestedPath + " -I \"c d\"");
+    std::string cyclePath = writeCheckFile("-v\n");
+    int fd = open(cyclePath.c_str(), O_WRONLY | O_TRUNC);
+    std::string cycle = "-v @" + cyclePath;
+    bool written = fd >= 0 && write(fd, cycle.data(), cycle.size()) == (ssize_t) cycle.size();
+    if (fd >= 0)
+        close(fd);
+    check(written && !emptyPath.empty() && !nestedPath.empty() && !path.empty(), "response file check writes its files");
+    std::string argument = "@" + path, cycleArgument = "@" + cyclePath;
+    char *argv[] = {(char *) "check", argument.data(), (char *) "-q", nullptr};
+    DArgumentOption verbose({'v'}, {"verbose"}), quiet({'q'}, {"quiet"}), output(DArgumentOptionType::InputOption, {'o'}, {"output"}), include(DArgumentOptionType::InputOption, {'I'}, {"include"});
+    include.SetMultipleValues(true);
+    auto describe = [&](DParseResult result, const std::vector<std::string_view> &positional) {
+        std::string text = std::to_string((int) result) + " " + std::to_string(verbose.WasSet()) + std::to_string(quiet.WasSet()) + " " + output.GetValue();
+        for (auto value: include.GetValues())
+            text.append("|").append(value);
+        for (auto value: positional)
+            text.append(" ").append(value);
+        return text;
+    };
+    DArgumentParser parser(3, argv);
+    parser.AddArgumentOption({&verbose, &quiet, &output, &include});
+    parser.SetResponseFileExpansion(true);
+    DParseResult result = parser.Parse();
+    std::vector<std::string_view> positional(parser.GetPositionalArgumentViews().begin(), parser.GetPositionalArgumentViews().end());
+    check(describe(result, positional) == "0 11 a b|nested arg|c d positional", "response files are expanded in place, nested ones too");
+    parser.SetResponseFileExpansion(false);
+    result = parser.Parse();
+    positional.assign(parser.GetPositionalArgumentViews().begin(), parser.GetPositionalArgumentViews().end());
+    check(describe(result, positional) == "0 01  " + argument, "response files are positional arguments unless expansion is enabled");
+    parser.SetResponseFileExpansion(true);
+    result = parser.ParseCommandString("-v @/nonexistent/DArgumentParserChecks");
+    check(result == DParseResult::InvalidResponseFile && parser.ErrorText() == "Response file /nonexistent/DArgumentParserChecks could not be read", "a missing response file is reported");
+    result = parser.ParseCommandString(cycleArgument);
+    check(result == DParseResult::InvalidResponseFile && parser.ErrorText().find(cyclePath) != std::string::npos, "a response file that references itself is reported instead of expanding forever");
+    DArgumentSchema schema({&verbose, &quiet, &output, &include}, true);
+    DParseOutcome outcome = schema.Parse(3, argv);
+    std::string outcomeText = std::to_string((int) outcome.Result()) + " " + std::to_string(outcome.Get(include).GetValues().size()) + " " + outcome.Get(output).GetValue();
+    check(outcomeText == "0 2 a b" && outcome.GetPositionalArgumentViews().size() == 1, "a schema expands response files too");
+    for (const auto &file: {emptyPath, nestedPath, path, cyclePath})
+        unlink(file.c_str());
+}
+
+/**
+ * The variables of the binding check, with defaults that differ from anything a parse sets.
+ */
+struct BoundConfig {
+    bool verbose = false;
+    int count = 0;
+    int jobs = 1;
+    long long big = 5;
+    double ratio = 0.5;
+    std::chrono::nanoseconds timeout{7};
+    unsigned long long limit = 9;
+    std::string output = "default";
+    std::string number = "none";
+    bool color = true;
+
+    [[nodiscard]] std::string describe() const {
+        return std::to_string(verbose) + " " + std::to_string(count) + " " + std::to_string(jobs) + " " + std::to_string(big) + " " + std::to_string(ratio) + " " + std::to_string(timeout.count()) + " " + std::to_string(limit) + " " + output + " " + number + " " + std::to_string(color);
+    }
+};
+
+/**
+ * Binds options of every type to variables and checks what parses from the command line, the environment and the config file write to them, the defaults written back, the rejected bindings and the int overflow.
+ */
+void checkBindings() {
+    std::string path = writeCheckFile("ratio = 4\n");
+    check(!path.empty(), "binding check writes its config file");
+    BoundConfig config;
+    DArgumentOption verbose({'v'}, {"verbose"}), count({'c'}, {"count"});
+    DArgumentOption jobs(DArgumentOptionType::InputOption, {'j'}, {"jobs"}), big(DArgumentOptionType::InputOption, {}, {"big"}), ratio(DArgumentOptionType::InputOption, {}, {"ratio"});
+    DArgumentOption timeout(DArgumentOptionType::InputOption, {}, {"timeout"}), limit(DArgumentOptionType::InputOption, {}, {"limit"}), output(DArgumentOptionType::InputOption, {'o'}, {"output"});
+    DArgumentOption number(DArgumentOptionType::InputOption, {'n'}, {"number"}), color(DArgumentOptionType::InputOption, {}, {"color"});
+    number.SetValueType(DArgumentValueType::Integer);
+    bool bound = verbose.Bind(config, &BoundConfig::verbose) && count.Bind(config, &BoundConfig::count) && jobs.Bind(config, &BoundConfig::jobs) && big.Bind(config, &BoundConfig::big);
+    bound &= ratio.Bind(config, &BoundConfig::ratio) && timeout.Bind(config, &BoundConfig::timeout) && limit.Bind(config, &BoundConfig::limit) && output.Bind(config, &BoundConfig::output);
+    bound &= number.Bind(config, &BoundConfig::number) && color.Bind(config, &BoundConfig::color);
+    double unboundRatio = 0;
+    std::string unboundText;
+    check(bound && !verbose.Bind(unboundRatio) && !count.Bind(unboundText), "options that don't take a value can only be bound to bool, int and long long");
+    check(jobs.GetValueType() == DArgumentValueType::Integer && timeout.GetValueType() == DArgumentValueType::Duration && limit.GetValueType() == DArgumentValueType::ByteSize && output.GetValueType() == DArgumentValueType::String && number.GetValueType() == DArgumentValueType::Integer, "binding sets the value type to match the variable, strings keep it");
+
+    char *argv[] = {(char *) "check", nullptr};
+    DArgumentParser parser(1, argv);
+    parser.AddArgumentOption({&verbose, &count, &jobs, &big, &ratio, &timeout, &limit, &output, &number, &color});
+    output.SetEnvironmentVariable("CHECK_BOUND_OUTPUT");
+    parser.RemoveArgumentOption(output);
+    parser.AddArgumentOption(output);
+    char *environment[] = {(char *) "CHECK_BOUND_OUTPUT=fromenv", nullptr};
+    char *noVariables[] = {nullptr};
+    parser.SetEnvironment(noVariables);
+    DParseResult result = parser.ParseCommandString("-v -cc -c --jobs 4 --big=9999999999 --ratio=2.5 --timeout=1s --limit=1K -o file -n 12 --color=no");
+    check(result == DParseResult::ParseSuccessful && config.describe() == "1 3 4 9999999999 2.500000 1000000000 1024 file 12 0", "parses write the results to the bound variables");
+    result = parser.Parse();
+    check(result == DParseResult::ParseSuccessful && config.describe() == "0 0 1 5 0.500000 7 9 default none 1", "the defaults are written back when the options aren't set");
+    parser.SetEnvironment(environment);
+    parser.LoadConfigFile(path);
+    result = parser.Parse();
+    check(result == DParseResult::ParseSuccessful && config.describe() == "0 0 1 5 4.000000 7 9 fromenv none 1", "the environment and the config file write to the bound variables");
+    result = parser.ParseCommandString("--jobs=2147483648");
+    check(result == DParseResult::InvalidValue && parser.ErrorText() == "Option --jobs received a value in an invalid format", "integers that don't fit in a bound int fail the parse");
+    result = parser.ParseCommandString("--big=2147483648 --number=x");
+    check(result == DParseResult::InvalidValue && parser.ErrorText() == "Option --number received a value in an invalid format" && config.big == 2147483648LL, "a string bound to a typed option still has its value converted");
+
+    DArgumentSchema schema({&verbose, &jobs});
+    char *schemaArgv[] = {(char *) "check", (char *) "-v", (char *) "--jobs=8", nullptr};
+    parser.ClearConfigFile();
+    (void) parser.Parse();
+    DParseOutcome outcome = schema.Parse(3, schemaArgv);
+    check(outcome.WasSet(verbose) && outcome.Get(jobs).GetIntegerValue() == 8 && !config.verbose && config.jobs == 1, "schema outcomes don't write to bound variables");
+    int otherJobs = 3;
+    jobs.Bind(otherJobs);
+    result = parser.ParseCommandString("--jobs=6");
+    check(result == DParseResult::ParseSuccessful && otherJobs == 6 && config.jobs == 1, "binding another variable leaves the previous one alone");
+    unlink(path.c_str());
+}
+
+/**
+ * Parses a known argv twice and a failing command string once, comparing what the statistics and the observer report with what they should count.
+ */
+void checkStatistics() {
+    char *argv[] = {(char *) "check", (char *) "-v", (char *) "--output", (char *) "file", (char *) "positional", (char *) "--num=3", nullptr};
+    DArgumentParser parser(6, argv);
+    DArgumentOption verbose({'v'}, {"verbose"}), output(DArgumentOptionType::InputOption, {'o'}, {"output"}), number(DArgumentOptionType::InputOption, {'n'}, {"num"});
+    parser.AddArgumentOption({&verbose, &output, &number});
+    std::vector<DParseStatistics> observed;
+    parser.SetStatisticsObserver([&observed](const DParseStatistics &statistics) { observed.push_back(statistics); });
+    bool parsed = parser.Parse() == DParseResult::ParseSuccessful && parser.Parse() == DParseResult::ParseSuccessful;
+    check(parsed && parser.ParseCommandString("--bogus") == DParseResult::InvalidOption, "statistics check parses as expected");
+    const DParseStatistics &total = parser.GetStatistics();
+#ifdef DARGUMENTPARSER_INSTRUMENTATION
+    check(observed.size() == 3, "the statistics observer is called once per parse");
+    if (observed.size() != 3)
+        return;
+    //one probe per command: -v, --output and --num, the values and the positional argument aren't looked up
+    check(observed[0].tokens == 5 && observed[0].lookupProbes == 3 && observed[0].errors == 0 && observed[0].parses == 1, "statistics count the tokens and probes of a parse");
+    check(observed[0].allocations > 0 && observed[1].allocations == 0, "statistics count the allocations, none once the storage is reused");
+    check(observed[2].tokens == 1 && observed[2].errors == 1 && observed[2].lookupProbes >= 1, "statistics count a failed parse");
+    check(total.parses == 3 && total.errors == 1 && total.tokens == 11 && total.lookupProbes == observed[0].lookupProbes + observed[1].lookupProbes + observed[2].lookupProbes, "total statistics add up every parse");
+    parser.ResetStatistics();
+    check(parser.GetStatistics().parses == 0 && parser.GetStatistics().tokens == 0, "statistics are reset");
+#else
+    check(observed.empty() && total.parses == 0 && total.tokens == 0 && total.allocations == 0, "statistics stay 0 without instrumentation");
+#endif
+}
+
+/**
+ * Runs every check, they only compare results so they run the same in any build type.
+ * @return true if all of them passed.
+ */
+bool runChecks() {
+    checkHelpTextCache();
+    checkTokenizer();
+    checkSuggestions();
+    checkArgumentViews();
+    checkStaticParser();
+    checkValueConversion();
+    checkCommandIndex();
+    checkAbbreviations();
+    checkBatchRegistration();
+    checkLazyParse();
+    checkArgumentEditing();
+    checkArgumentEditingErrors();
+    checkEnvironment();
+    checkConfigFile();
+    checkSubcommands();
+    checkResponseFiles();
+    checkCompletions();
+    checkSchema();
+    checkBatch();
+    checkSchemaImage();
+    checkBindings();
+    checkStatistics();
+    std::printf("%s\n", failedChecks == 0 ? "all checks passed" : "some checks failed");
+    return failedChecks == 0;
+}
+
+int main(int argc, char **argv) {
+    DArgumentParser parser(argc, argv, "DArgumentParserBench", "1.0", "Measures DArgumentParser against synthetic schemas and argv vectors.");
+    DArgumentOption helpOption(DArgumentOptionType::HelpOption, {'h'}, {"help"}, "Prints out this message.");
+    DArgumentOption quickOption({'q'}, {"quick"}, "Runs a reduced matrix of workloads.");
+    DArgumentOption optionsOption(DArgumentOptionType::InputOption, {'o'}, {"options"}, "Only run schemas with this amount of options.");
+    DArgumentOption tokensOption(DArgumentOptionType::InputOption, {'t'}, {"tokens"}, "Only run argv vectors with this amount of tokens.");
+    DArgumentOption checkOption({'c'}, {"check"}, "Runs the behavior checks instead of the benchmarks, failing if any of them fails.");
+    parser.AddArgumentOption({&helpOption, &quickOption, &optionsOption, &tokensOption, &checkOption});
+    std::setvbuf(stdout, nullptr, _IOLBF, 0);
+    if (parser.Parse() != DParseResult::ParseSuccessful) {
+        std::fprintf(stderr, "%s\n", parser.ErrorText().c_str());
+        return EXIT_FAILURE;
+    }
+    if (helpOption.WasSet()) {
+        std::printf("%s", parser.HelpText().c_str());
+        return EXIT_SUCCESS;
+    }
+    if (checkOption.WasSet())
+        return runChecks() ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    std::vector<int> optionCounts = {10, 100, 1000, 10000}, tokenCounts = {1, 100, 10000, 1000000};
+    long long minimumWork = 2000000;
+    if (quickOption.WasSet()) {
+        optionCounts = {10, 1000};
+        tokenCounts = {100, 10000};
+        minimumWork = 200000;
+    }
+    if (optionsOption.WasSet())
+        optionCounts = {std::atoi(optionsOption.GetValue().c_str())};
+    if (tokensOption.WasSet())
+        tokenCounts = {std::atoi(tokensOption.GetValue().c_str())};
+
+#ifndef NDEBUG
+    std::printf("warning: built without NDEBUG, configure with -DCMAKE_BUILD_TYPE=Release for meaningful numbers\n");
+#endif
+    std::printf("%-12s %8s %9s %12s %12s %14s %10s\n", "workload", "options", "tokens", "ns/unit", "getopt_long", "allocs/call", "peak KiB");
+    for (int optionCount: optionCounts) {
+        SyntheticSchema schema(optionCount);
+        benchmarkRegistration(schema, minimumWork / 100);
+        benchmarkWasSet(schema, minimumWork);
+        benchmarkConfigFile(schema, minimumWork);
+        benchmarkSubcommands(schema, minimumWork / 100);
+        benchmarkCompletion(schema, minimumWork);
+        benchmarkSuggestion(schema, minimumWork);
+        benchmarkSchemaImage(schema, minimumWork);
+        benchmarkHelpText(schema, minimumWork);
+        for (int tokenCount: tokenCounts)
+            benchmarkParse(schema, tokenCount, minimumWork);
+        benchmarkBatch(schema, 10, minimumWork);
+        benchmarkTokenize(schema, 100000, minimumWork);
+    }
+    benchmarkMultipleValues(100000, minimumWork);
+    return EXIT_SUCCESS;
+}